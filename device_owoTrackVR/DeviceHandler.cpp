@@ -52,10 +52,10 @@ void DeviceHandler::initialize()
 	if (m_status_result == R_E_NOT_STARTED)
 	{
 		// Construct the networking server
-		m_data_server = new UDPDeviceQuatServer(&m_net_port);
+		m_data_server.reset(new UDPDeviceQuatServer(&m_net_port));
 
 		bool _return = false;
-		m_info_server = new InfoServer(_return);
+		m_info_server.reset(new InfoServer(_return));
 
 		if (!_return)
 		{
@@ -68,8 +68,7 @@ void DeviceHandler::initialize()
 			return; // Give up
 		}
 
-		m_info_server->set_port_no(m_data_server->get_port());
-		m_info_server->add_tracker();
+		m_info_server->add_tracker(m_data_server->get_port(), "Default");
 
 		// Start listening
 		try
@@ -124,6 +123,11 @@ void DeviceHandler::update()
 
 	if (initialized)
 	{
+		// Record the HMD pose once per frame, the server
+		// thread picks the one matching its sensor sample
+		m_hmd_pose_history.push(
+			std::chrono::steady_clock::now(), getHMDPoseCalibrated());
+
 		// Make sure that we're running correctly
 		if (m_status_result != S_OK)return;
 
@@ -145,11 +149,13 @@ void DeviceHandler::shutdown()
 
 	initialized = false;
 	save_settings(); // Back everything up
+	m_settings_store.flush(); // And make sure it's on disk
 }
 
 void DeviceHandler::signalJoint(uint32_t at)
 {
-	m_data_server->buzz(0.7, 100.0, 0.5);
+	// Queued, the network thread sends it
+	m_haptics.buzz(m_data_server.get(), 0.7f, 100.0f, 0.5f);
 }
 
 void DeviceHandler::calculatePose()
@@ -157,6 +163,57 @@ void DeviceHandler::calculatePose()
 	// Mark that we see the user
 	skeletonTracked = true;
 
+	// Pick up a freshly solved calibration, if there's one
+	if (m_calibration_result_pending)
+	{
+		{
+			std::scoped_lock lock(m_calibration_result_mutex, m_settings_mutex);
+			(m_calibration_result_forward ? m_global_rotation : m_local_rotation) = m_calibration_result;
+			m_calibration_result_pending = false;
+
+			// Start tracking drift against the new forward
+			if (m_calibration_result_forward)
+				m_yaw_drift_estimator.reset();
+		}
+
+		// Back it up right away, the calibrating thread may have given up waiting
+		save_settings();
+	}
+
+	// Use the HMD pose from when the rotation arrived,
+	// fall back to the current one until there's some history
+	HMDPoseHistory::pose_t hmd_pose;
+	if (!m_hmd_pose_history.sample(m_data_server->getRotationTimestamp(), hmd_pose))
+		hmd_pose = getHMDPoseCalibrated();
+
+	const double* p_remote_rotation = m_data_server->getRotationQuaternion();
+	m_stationary_detector.push(m_data_server->getGyroscope(), m_data_server->getAccel());
+	const bool stationary = m_stationary_detector.is_stationary();
+
+	// While the device is lying still and neither the inputs, the calibration
+	// nor the (decaying) predicted offset have changed, the last pose still holds
+	const PoseInputs pose_inputs{
+		{p_remote_rotation[0], p_remote_rotation[1], p_remote_rotation[2], p_remote_rotation[3]},
+		hmd_pose.first, hmd_pose.second,
+		m_global_offset, m_device_offset, m_tracker_offset,
+		m_global_rotation, m_local_rotation
+	};
+
+	const bool predicting = !m_is_calibrating_forward && m_should_predict_position_tracker_wise;
+
+	if (stationary &&
+		!m_is_calibrating_forward && !m_is_calibrating_down &&
+		(!predicting || m_pos_predictor.is_settled()) &&
+		pose_inputs.matches(m_last_pose_inputs))
+	{
+		m_pose_stats.skipped++;
+		report_pose_stats();
+		return;
+	}
+
+	m_last_pose_inputs = pose_inputs;
+	const auto compute_start = std::chrono::steady_clock::now();
+
 	/* Prepare for the position calculations */
 
 	Basis offset_basis;
@@ -164,9 +221,9 @@ void DeviceHandler::calculatePose()
 	Vector3 offset_global = m_global_offset;
 	Vector3 offset_local_device = m_device_offset;
 	Vector3 offset_local_tracker = m_tracker_offset;
-	m_pose.first = getHMDPoseCalibrated().first; // Zero the position vector
+	m_pose.first = hmd_pose.first; // Zero the position vector
 
-	Eigen::Matrix3d rotation = getHMDPoseCalibrated().second.toRotationMatrix();
+	Eigen::Matrix3d rotation = hmd_pose.second.toRotationMatrix();
 	offset_basis.set(
 		rotation(0, 0),
 		rotation(0, 1),
@@ -184,8 +241,6 @@ void DeviceHandler::calculatePose()
 	// Acceleration is not used as of now
 	// double* acceleration = m_data_server->getAccel();
 
-	const double* p_remote_rotation = m_data_server->getRotationQuaternion();
-
 	auto p_remote_quaternion = Quat(
 		p_remote_rotation[0], p_remote_rotation[1],
 		p_remote_rotation[2], p_remote_rotation[3]);
@@ -194,26 +249,60 @@ void DeviceHandler::calculatePose()
 		Quat(Vector3(1, 0, 0), -Math_PI / 2.0) * p_remote_quaternion;
 
 
+	// While calibrating, preview with the latest sample's
+	// rotation and leave the averaging to the solver
+	Quat global_rotation = m_global_rotation;
 	if (m_is_calibrating_forward)
 	{
-		m_global_rotation =
+		global_rotation =
 			Quat(Vector3(0, (get_yaw(p_remote_quaternion)) -
-			             (get_yaw(offset_basis, Vector3(0, 0, -1))), 0)).to_eigen<double>();
+			             (get_yaw(offset_basis, Vector3(0, 0, -1))), 0));
+		m_calibration_solver.push_sample(global_rotation);
 
 		offset_global = (offset_basis.xform(Vector3(0, 0, -1)) *
 			Vector3(1, 0, 1)).normalized() + Vector3(0, 0.2, 0);
 		offset_local_device = Vector3(0, 0, 0);
 		offset_local_tracker = Vector3(0, 0, 0);
 	}
+	else if (!m_is_calibrating_down && m_should_correct_yaw_drift && !stationary)
+	{
+		// Compare against what a forward calibration would give right now,
+		// and nudge the global rotation towards it if it's been drifting
+		// (not while lying still, so the reused pose stays valid)
+		const double hmd_yaw = get_yaw(offset_basis, Vector3(0, 0, -1));
+		const double* gyro = m_data_server->getGyroscope();
+
+		const double correction = m_yaw_drift_estimator.update(
+			m_data_server->getRotationTimestamp(),
+			get_yaw(p_remote_quaternion) - hmd_yaw,
+			global_rotation.get_euler_yxz().y, hmd_yaw,
+			Vector3(gyro[0], gyro[1], gyro[2]).length());
+
+		if (correction != 0.0)
+		{
+			global_rotation = Quat(Vector3(0, correction, 0)) * global_rotation;
+			const Eigen::Quaterniond corrected = global_rotation.to_eigen<double>();
+			{
+				// save_settings() reads it from the UI threads
+				std::lock_guard lock(m_settings_mutex);
+				m_global_rotation = corrected;
+			}
+			m_last_pose_inputs.global_rotation = corrected; // Already applied
+		}
+	}
 
-	p_remote_quaternion = Quat(m_global_rotation) * p_remote_quaternion;
+	p_remote_quaternion = global_rotation * p_remote_quaternion;
 
+	Quat local_rotation = m_local_rotation;
 	if (m_is_calibrating_down)
-		m_local_rotation =
-		(Quat(p_remote_quaternion.inverse().get_euler_yxz()) *
-			Quat(Vector3(0, 1, 0), -getHMDOrientationYawCalibrated())).to_eigen<double>();
+	{
+		local_rotation =
+			Quat(p_remote_quaternion.inverse().get_euler_yxz()) *
+			Quat(Vector3(0, 1, 0), -getHMDOrientationYawCalibrated());
+		m_calibration_solver.push_sample(local_rotation);
+	}
 
-	p_remote_quaternion = p_remote_quaternion * Quat(m_local_rotation);
+	p_remote_quaternion = p_remote_quaternion * local_rotation;
 	m_pose.second = p_remote_quaternion.to_eigen<double>();
 
 	// Angular velocity is not used as of now
@@ -221,21 +310,50 @@ void DeviceHandler::calculatePose()
 
 	const auto final_tracker_basis = Basis(p_remote_quaternion);
 
+	// Transform each offset once, not once per axis
+	const Vector3 offset_device = offset_basis.xform(offset_local_device),
+	              offset_tracker = final_tracker_basis.xform(offset_local_tracker);
+
 	for (int i = 0; i < 3; i++)
 	{
 		m_pose.first(i) += offset_global.get_axis(i);
-		m_pose.first(i) += offset_basis.xform(offset_local_device).get_axis(i);
-		m_pose.first(i) += final_tracker_basis.xform(offset_local_tracker).get_axis(i);
+		m_pose.first(i) += offset_device.get_axis(i);
+		m_pose.first(i) += offset_tracker.get_axis(i);
 	}
 
-	if (!m_is_calibrating_forward && m_should_predict_position_tracker_wise)
+	if (predicting)
 	{
-		auto b = Basis(p_remote_quaternion);
-		const Vector3 result = m_pos_predictor.predict(*m_data_server, b) *
+		const Vector3 result = m_pos_predictor.predict(
+				*m_data_server, final_tracker_basis, stationary) *
 			m_position_prediction_strength_tracker_wise;
 
 		m_pose.first(0) += result.x;
 		m_pose.first(1) += result.y;
 		m_pose.first(2) += result.z;
 	}
+
+	m_pose_stats.computed++;
+	m_pose_stats.compute_time += std::chrono::steady_clock::now() - compute_start;
+	report_pose_stats();
+}
+
+void DeviceHandler::report_pose_stats()
+{
+	const auto now = std::chrono::steady_clock::now();
+	if (now - m_pose_stats.last_report < std::chrono::minutes(1)) return;
+
+	// Average cost of a full pose, times how many weren't needed
+	const double average_us = m_pose_stats.computed > 0
+		                          ? std::chrono::duration<double, std::micro>(m_pose_stats.compute_time).count() /
+		                          static_cast<double>(m_pose_stats.computed)
+		                          : 0.0;
+
+	LOG(INFO) << "OWO Device: Poses computed: " << m_pose_stats.computed <<
+		", reused while stationary: " << m_pose_stats.skipped <<
+		" (~" << average_us * static_cast<double>(m_pose_stats.skipped) << "us saved), " <<
+		"velocity zeroed by ZUPT: " << m_pos_predictor.get_zeroed_velocity();
+
+	m_pose_stats = {};
+	m_pos_predictor.reset_zeroed_velocity();
+	m_pose_stats.last_report = now;
 }
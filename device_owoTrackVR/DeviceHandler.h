@@ -6,11 +6,8 @@
 #include <Amethyst_API_Devices.h>
 #include <Amethyst_API_Paths.h>
 
-#include <cereal/types/unordered_map.hpp>
-#include <cereal/types/memory.hpp>
-#include <cereal/archives/xml.hpp>
-
-#include <fstream>
+#include <atomic>
+#include <mutex>
 #include <thread>
 #include <WinSock2.h>
 #include <iphlpapi.h>
@@ -19,9 +16,16 @@
 #pragma comment(lib, "ws2_32.lib")
 #pragma comment(lib, "iphlpapi.lib")
 
+#include <CalibrationSolver.h>
+#include <HapticsScheduler.h>
+#include <HMDPoseHistory.h>
 #include <InfoServer.h>
 #include <PositionPredictor.h>
+#include <StationaryDetector.h>
 #include <UDPDeviceQuatServer.h>
+#include <YawDriftEstimator.h>
+
+#include "SettingsStore.h"
 
 /* Status enumeration */
 #define R_E_CONNECTION_DEAD 0x83010001 // No connection
@@ -31,25 +35,6 @@
 
 #define R_E_NOT_STARTED 0x83010005 // Disconnected (initial)
 
-/* Eigen serialization */
-
-namespace cereal
-{
-	template <class Archive>
-	void serialize(Archive& archive,
-	               Eigen::Vector3d& v)
-	{
-		archive(v.x(), v.y(), v.z());
-	}
-
-	template <class Archive>
-	void serialize(Archive& archive,
-	               Eigen::Quaterniond& q)
-	{
-		archive(q.w(), q.x(), q.y(), q.z());
-	}
-}
-
 /* Not exported */
 
 class DeviceHandler : public ktvr::K2TrackingDeviceBase_JointsBasis
@@ -207,10 +192,11 @@ public:
 					return; // Abort
 				}
 
+				m_calibration_solver.begin();
 				m_is_calibrating_forward = true;
 
 				m_calibration_text_block->Text(requestLocalizedString(L"/Plugins/OWO/Settings/Notices/Still"));
-				std::this_thread::sleep_for(std::chrono::seconds(4));
+				solve_calibration(true);
 
 				m_is_calibrating_forward = false;
 				m_calibration_text_block->Visibility(false);
@@ -220,7 +206,7 @@ public:
 				m_calibrate_forward_button->IsEnabled(true);
 				m_calibrate_down_button->IsEnabled(true);
 
-				save_settings(); // Back everything up
+				// The pose thread saves the result once it's applied
 				update_ui_worker();
 			}).detach();
 		};
@@ -245,15 +231,16 @@ public:
 				std::this_thread::sleep_for(std::chrono::seconds(7));
 				if (!initialized)
 				{
-					m_is_calibrating_forward = false;
+					m_is_calibrating_down = false;
 					m_calibration_text_block->Visibility(false);
 					return; // Abort
 				}
 
+				m_calibration_solver.begin();
 				m_is_calibrating_down = true;
 
 				m_calibration_text_block->Text(requestLocalizedString(L"/Plugins/OWO/Settings/Notices/Still"));
-				std::this_thread::sleep_for(std::chrono::seconds(4));
+				solve_calibration(false);
 
 				m_is_calibrating_down = false;
 				m_calibration_text_block->Visibility(false);
@@ -263,7 +250,7 @@ public:
 				m_calibrate_forward_button->IsEnabled(true);
 				m_calibrate_down_button->IsEnabled(true);
 
-				save_settings(); // Back everything up
+				// The pose thread saves the result once it's applied
 				update_ui_worker();
 			}).detach();
 		};
@@ -353,67 +340,46 @@ public:
 
 	void save_settings()
 	{
-		if (std::ofstream output(
-				ktvr::GetK2AppDataFileDir(L"Device_OWO_settings.xml"));
-			output.fail())
-		{
-			LOG(ERROR) << "OWO Device Error: Couldn't save settings!\n";
-		}
-		else
-		{
-			cereal::XMLOutputArchive archive(output);
-			LOG(INFO) << "OWO Device: Attempted to save settings";
+		std::lock_guard lock(m_settings_mutex);
 
-			try
-			{
-				archive(
-					//CEREAL_NVP(m_net_port),
-					CEREAL_NVP(m_global_offset),
-					CEREAL_NVP(m_device_offset),
-					CEREAL_NVP(m_tracker_offset),
-					CEREAL_NVP(m_global_rotation),
-					CEREAL_NVP(m_local_rotation)
-				);
-			}
-			catch (...)
-			{
-				LOG(ERROR) << "OWO Device Error: Couldn't save settings, an exception occurred!\n";
-			}
-		}
+		// Update this tracker, keep the others as they were
+		m_settings.m_global_offset = m_global_offset;
+		m_settings.m_trackers[m_net_port] = {
+			m_device_offset, m_tracker_offset,
+			m_global_rotation, m_local_rotation
+		};
+
+		m_settings_store.save(m_settings); // Written in the background
 	}
 
 	void load_settings()
 	{
-		if (std::ifstream input(
-				ktvr::GetK2AppDataFileDir(L"Device_OWO_settings.xml"));
-			input.fail())
+		std::lock_guard lock(m_settings_mutex);
+
+		if (!m_settings_store.load(m_settings, m_net_port))
 		{
-			LOG(WARNING) << "OWO Device Error: Couldn't read settings, re-generating!\n";
-			save_settings(); // Re-generate the file
+			m_settings.m_trackers[m_net_port] = {};
+			m_settings_store.save(m_settings); // Re-generate the file
+			return;
 		}
-		else
-		{
-			LOG(INFO) << "OWO Device: Attempting to read settings";
 
-			try
-			{
-				cereal::XMLInputArchive archive(input);
-				archive(
-					//CEREAL_NVP(m_net_port),
-					CEREAL_NVP(m_global_offset),
-					CEREAL_NVP(m_device_offset),
-					CEREAL_NVP(m_tracker_offset),
-					CEREAL_NVP(m_global_rotation),
-					CEREAL_NVP(m_local_rotation)
-				);
-			}
-			catch (...)
-			{
-				LOG(ERROR) << "OWO Device Error: Couldn't read settings, an exception occurred!\n";
-			}
+		m_global_offset = m_settings.m_global_offset;
+		if (const auto tracker = m_settings.m_trackers.find(m_net_port);
+			tracker != m_settings.m_trackers.end())
+		{
+			m_device_offset = tracker->second.m_device_offset;
+			m_tracker_offset = tracker->second.m_tracker_offset;
+			m_global_rotation = tracker->second.m_global_rotation;
+			m_local_rotation = tracker->second.m_local_rotation;
 		}
 	}
 
+	// OWO Settings, all trackers' and the backing store
+	// (the mutex also guards the rotations below, the pose thread updates them)
+	SettingsStore m_settings_store;
+	DeviceSettings m_settings;
+	std::mutex m_settings_mutex;
+
 	// OWO Tracker Settings' Hip Dislocation
 	Eigen::Vector3d m_global_offset{0, 0, 0},
 	                m_device_offset{0, -0.045, 0.09},
@@ -429,6 +395,9 @@ public:
 	bool m_should_predict_position_tracker_wise = false;
 	double m_position_prediction_strength_tracker_wise = 1.0;
 
+	// OWO Continuous yaw drift correction (against the HMD), experimental
+	bool m_should_correct_yaw_drift = false;
+
 	// TODO NOT IN SETTINGS /\
 
 	// OWO Interfacing Port
@@ -438,6 +407,49 @@ public:
 	bool m_is_calibrating_forward = false,
 	     m_is_calibrating_down = false;
 
+	// OWO Calibration solver, samples are pushed from the pose thread
+	// and the solved rotation is handed back to it through the pending flag
+	// (the pose thread applies it under the settings lock, then saves)
+	CalibrationSolver m_calibration_solver;
+	std::mutex m_calibration_result_mutex;
+	std::atomic_bool m_calibration_result_pending = false;
+	Eigen::Quaterniond m_calibration_result{1, 0, 0, 0};
+	bool m_calibration_result_forward = false;
+
+	void solve_calibration(const bool& forward)
+	{
+		CalibrationSolver::Result result;
+		bool solved = false;
+
+		// Finish as soon as the user has settled, give up after 4s
+		const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(4);
+		while (initialized && std::chrono::steady_clock::now() < deadline)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			if ((solved = m_calibration_solver.try_solve(result)))break;
+		}
+
+		if (!solved && !m_calibration_solver.solve_final(result))
+		{
+			LOG(WARNING) << "OWO Device: No calibration samples were collected, keeping the old calibration";
+			return;
+		}
+
+		LOG(INFO) << "OWO Device: Calibration " << (solved ? "converged" : "timed out") <<
+			" with " << result.samples << " samples, confidence: " << result.confidence;
+
+		{
+			std::lock_guard lock(m_calibration_result_mutex);
+			m_calibration_result = result.rotation.to_eigen<double>();
+			m_calibration_result_forward = forward;
+		}
+		m_calibration_result_pending = true;
+
+		// Wait (a bit) for the pose thread to pick it up
+		for (int i = 0; i < 50 && m_calibration_result_pending && initialized; i++)
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
 	// Interface elements
 	ktvr::Interface::TextBlock *m_ip_text_block, *m_ip_label_text_block,
 	                           *m_port_text_block, *m_port_label_text_block,
@@ -448,9 +460,55 @@ public:
 	bool m_hip_height_value_change_pending = false;
 
 	/* Internal, helper variables */
-	UDPDeviceQuatServer* m_data_server;
-	InfoServer* m_info_server;
+	std::unique_ptr<UDPDeviceQuatServer> m_data_server;
+	std::unique_ptr<InfoServer> m_info_server;
 	PositionPredictor m_pos_predictor;
+	HapticsScheduler m_haptics;
+	HMDPoseHistory m_hmd_pose_history;
+	YawDriftEstimator m_yaw_drift_estimator;
+	StationaryDetector m_stationary_detector;
+
+	// Everything a pose is computed from, to tell if recomputing would change it
+	struct PoseInputs
+	{
+		Eigen::Vector4d remote_rotation{0, 0, 0, 0};
+		Eigen::Vector3d hmd_position{0, 0, 0};
+		Eigen::Quaterniond hmd_rotation{1, 0, 0, 0};
+
+		Eigen::Vector3d global_offset{0, 0, 0},
+		                device_offset{0, 0, 0},
+		                tracker_offset{0, 0, 0};
+
+		Eigen::Quaterniond global_rotation{1, 0, 0, 0},
+		                   local_rotation{1, 0, 0, 0};
+
+		[[nodiscard]] bool matches(const PoseInputs& other) const
+		{
+			// Sensors are noisy even at rest, allow for that in the measured ones
+			return (remote_rotation - other.remote_rotation).squaredNorm() < 1e-10 &&
+				(hmd_position - other.hmd_position).squaredNorm() < 1e-8 && // 0.1mm
+				(hmd_rotation.coeffs() - other.hmd_rotation.coeffs()).squaredNorm() < 1e-10 &&
+				global_offset == other.global_offset &&
+				device_offset == other.device_offset &&
+				tracker_offset == other.tracker_offset &&
+				// The drift correction rewrites the global rotation,
+				// leave rounding in its Quat round trip out of it
+				(global_rotation.coeffs() - other.global_rotation.coeffs()).squaredNorm() < 1e-14 &&
+				(local_rotation.coeffs() - other.local_rotation.coeffs()).squaredNorm() < 1e-14;
+		}
+	};
+
+	PoseInputs m_last_pose_inputs;
+
+	// Reused vs computed poses (and ZUPT'd velocity), logged once a minute
+	struct PoseStats
+	{
+		uint64_t computed = 0, skipped = 0;
+		std::chrono::steady_clock::duration compute_time{0};
+		std::chrono::steady_clock::time_point last_report;
+	} m_pose_stats;
+
+	void report_pose_stats(); // Implemented in .cpp
 
 	HRESULT m_status_result = R_E_NOT_STARTED;
 
@@ -541,6 +599,17 @@ public:
 					LOG(ERROR) << "Error message: " << e.what();
 				}
 
+				/* Send queued haptics here */
+				try
+				{
+					m_haptics.tick();
+				}
+				catch (std::system_error& e)
+				{
+					LOG(ERROR) << "OWO Device Error: Haptics tick (buzz) failed!";
+					LOG(ERROR) << "Error message: " << e.what();
+				}
+
 				if (!m_data_server->isDataAvailable())
 				{
 					if (e_retries >= 180)
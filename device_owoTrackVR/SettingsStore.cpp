@@ -0,0 +1,237 @@
+#include "pch.h"
+#include "SettingsStore.h"
+
+#include <filesystem>
+#include <fstream>
+#include <glog/logging.h>
+
+#include <Amethyst_API_Paths.h>
+
+#include <cereal/archives/binary.hpp>
+#include <cereal/archives/xml.hpp>
+
+namespace
+{
+	const std::wstring settings_file_binary = L"Device_OWO_settings.bin";
+	const std::wstring settings_file_xml = L"Device_OWO_settings.xml";
+}
+
+SettingsStore::SettingsStore(const Format format) :
+	m_format(format),
+	m_worker(&SettingsStore::worker, this)
+{
+}
+
+SettingsStore::~SettingsStore()
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_exiting = true;
+	}
+	m_condition.notify_all();
+
+	if (m_worker.joinable())
+		m_worker.join(); // Writes out anything pending
+}
+
+bool SettingsStore::read_binary(DeviceSettings& settings)
+{
+	std::ifstream input(
+		ktvr::GetK2AppDataFileDir(settings_file_binary), std::ios::binary);
+	if (input.fail()) return false;
+
+	try
+	{
+		DeviceSettings _settings;
+		cereal::BinaryInputArchive archive(input);
+		archive(_settings);
+
+		settings = std::move(_settings);
+		return true;
+	}
+	catch (...)
+	{
+		LOG(ERROR) << "OWO Device Error: Couldn't read binary settings, an exception occurred!\n";
+		return false;
+	}
+}
+
+bool SettingsStore::read_xml(DeviceSettings& settings, uint32_t const& legacy_port)
+{
+	const auto path = ktvr::GetK2AppDataFileDir(settings_file_xml);
+
+	// Current layout
+	try
+	{
+		std::ifstream input(path);
+		if (input.fail()) return false;
+
+		DeviceSettings _settings;
+		cereal::XMLInputArchive archive(input);
+		archive(cereal::make_nvp("settings", _settings));
+
+		settings = std::move(_settings);
+		return true;
+	}
+	catch (...)
+	{
+	}
+
+	// Old single-tracker layout
+	try
+	{
+		std::ifstream input(path);
+		if (input.fail()) return false;
+
+		DeviceSettings _settings;
+		TrackerSettings _tracker;
+
+		cereal::XMLInputArchive archive(input);
+		archive(
+			cereal::make_nvp("m_global_offset", _settings.m_global_offset),
+			cereal::make_nvp("m_device_offset", _tracker.m_device_offset),
+			cereal::make_nvp("m_tracker_offset", _tracker.m_tracker_offset),
+			cereal::make_nvp("m_global_rotation", _tracker.m_global_rotation),
+			cereal::make_nvp("m_local_rotation", _tracker.m_local_rotation)
+		);
+
+		_settings.m_trackers[legacy_port] = _tracker;
+		settings = std::move(_settings);
+		return true;
+	}
+	catch (...)
+	{
+		LOG(ERROR) << "OWO Device Error: Couldn't read settings, an exception occurred!\n";
+		return false;
+	}
+}
+
+bool SettingsStore::load(DeviceSettings& settings, uint32_t const& legacy_port)
+{
+	LOG(INFO) << "OWO Device: Attempting to read settings";
+
+	if (m_format == Format::Binary && read_binary(settings))
+		return true;
+
+	if (read_xml(settings, legacy_port))
+	{
+		// Migrate to whatever we're using now
+		if (m_format == Format::Binary)
+		{
+			LOG(INFO) << "OWO Device: Migrating XML settings to the binary format";
+			std::lock_guard lock(m_write_mutex);
+			write(settings, Format::Binary);
+		}
+		return true;
+	}
+
+	LOG(WARNING) << "OWO Device Error: Couldn't read settings, re-generating!\n";
+	return false;
+}
+
+void SettingsStore::save(const DeviceSettings& settings)
+{
+	{
+		std::lock_guard lock(m_mutex);
+		const auto now = std::chrono::steady_clock::now();
+
+		if (!m_pending) m_pending_since = now;
+		m_pending = settings; // Newer settings replace older ones
+		m_pending_deadline = std::min(now + SAVE_DEBOUNCE, m_pending_since + SAVE_MAX_DELAY);
+	}
+	m_condition.notify_all();
+}
+
+void SettingsStore::flush()
+{
+	std::optional<DeviceSettings> pending;
+	{
+		std::lock_guard lock(m_mutex);
+		pending.swap(m_pending);
+	}
+
+	if (pending)
+	{
+		std::lock_guard lock(m_write_mutex);
+		write(*pending, m_format);
+	}
+}
+
+void SettingsStore::worker()
+{
+	std::unique_lock lock(m_mutex);
+
+	while (true)
+	{
+		// Sleep until there's something to save, then until it settles
+		m_condition.wait(lock, [this] { return m_pending || m_exiting; });
+		while (m_pending && !m_exiting &&
+			m_condition.wait_until(lock, m_pending_deadline) != std::cv_status::timeout)
+		{
+		}
+
+		if (m_pending)
+		{
+			DeviceSettings settings = std::move(*m_pending);
+			m_pending.reset();
+
+			// Grab the write lock before releasing the queue,
+			// so that a flush() can't write older data after us
+			std::lock_guard write_lock(m_write_mutex);
+			lock.unlock();
+			write(settings, m_format);
+			lock.lock();
+		}
+
+		if (m_exiting && !m_pending) return;
+	}
+}
+
+bool SettingsStore::write(const DeviceSettings& settings, const Format format)
+{
+	const auto path = ktvr::GetK2AppDataFileDir(
+		format == Format::Binary ? settings_file_binary : settings_file_xml);
+	const auto temp_path = path + L".tmp";
+
+	try
+	{
+		{
+			std::ofstream output(temp_path,
+			                     format == Format::Binary ? std::ios::binary | std::ios::trunc : std::ios::trunc);
+			if (output.fail())
+			{
+				LOG(ERROR) << "OWO Device Error: Couldn't save settings!\n";
+				return false;
+			}
+
+			if (format == Format::Binary)
+			{
+				cereal::BinaryOutputArchive archive(output);
+				archive(settings);
+			}
+			else
+			{
+				cereal::XMLOutputArchive archive(output);
+				archive(cereal::make_nvp("settings", settings));
+			} // The XML archive finishes writing when destroyed
+
+			output.flush();
+			if (output.fail())
+			{
+				LOG(ERROR) << "OWO Device Error: Couldn't save settings, the write failed!\n";
+				return false;
+			}
+		}
+
+		// Replace the old file in one go
+		std::filesystem::rename(temp_path, path);
+	}
+	catch (...)
+	{
+		LOG(ERROR) << "OWO Device Error: Couldn't save settings, an exception occurred!\n";
+		return false;
+	}
+
+	LOG(INFO) << "OWO Device: Saved settings";
+	return true;
+}
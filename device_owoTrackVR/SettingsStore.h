@@ -0,0 +1,127 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include <Eigen/Dense>
+
+#include <cereal/cereal.hpp>
+#include <cereal/types/unordered_map.hpp>
+
+/* Eigen serialization */
+
+namespace cereal
+{
+	template <class Archive>
+	void serialize(Archive& archive,
+	               Eigen::Vector3d& v)
+	{
+		archive(v.x(), v.y(), v.z());
+	}
+
+	template <class Archive>
+	void serialize(Archive& archive,
+	               Eigen::Quaterniond& q)
+	{
+		archive(q.w(), q.x(), q.y(), q.z());
+	}
+}
+
+/* Persisted settings */
+
+// Per-tracker settings, keyed by the tracker's port
+struct TrackerSettings
+{
+	// OWO Tracker Settings' Hip Dislocation
+	Eigen::Vector3d m_device_offset{0, -0.045, 0.09},
+	                m_tracker_offset{0, -0.75, 0};
+
+	// OWO Tracker Settings' Hip Rotation
+	Eigen::Quaterniond m_global_rotation{1, 0, 0, 0},
+	                   m_local_rotation{1, 0, 0, 0};
+
+	template <class Archive>
+	void serialize(Archive& archive)
+	{
+		archive(
+			CEREAL_NVP(m_device_offset),
+			CEREAL_NVP(m_tracker_offset),
+			CEREAL_NVP(m_global_rotation),
+			CEREAL_NVP(m_local_rotation)
+		);
+	}
+};
+
+struct DeviceSettings
+{
+	Eigen::Vector3d m_global_offset{0, 0, 0};
+	std::unordered_map<uint32_t, TrackerSettings> m_trackers;
+
+	template <class Archive>
+	void serialize(Archive& archive, const uint32_t version)
+	{
+		archive(
+			CEREAL_NVP(m_global_offset),
+			CEREAL_NVP(m_trackers)
+		);
+	}
+};
+
+CEREAL_CLASS_VERSION(DeviceSettings, 1);
+
+/* Settings persistence */
+
+// Writes settings from a background worker, coalescing rapid saves
+// Files are written to a temporary file and then renamed over the old one,
+// so a crash mid-write never leaves a half-written settings file behind
+class SettingsStore
+{
+public:
+	enum class Format
+	{
+		Binary, // Device_OWO_settings.bin, compact & fast to load
+		XML // Device_OWO_settings.xml, human-readable
+	};
+
+	explicit SettingsStore(Format format = Format::Binary);
+	~SettingsStore();
+
+	// Loads the saved settings, trying the binary file first and falling
+	// back to the XML one (migrating it). The old single-tracker XML layout
+	// is read into the tracker at legacy_port. Returns false if nothing was read
+	bool load(DeviceSettings& settings, uint32_t const& legacy_port);
+
+	// Schedules a save, returns immediately
+	void save(const DeviceSettings& settings);
+
+	// Writes out anything pending, blocks until done
+	void flush();
+
+private:
+	// Wait this long for more changes before writing,
+	// but never hold a change back for longer than the max
+	static constexpr std::chrono::milliseconds SAVE_DEBOUNCE{500};
+	static constexpr std::chrono::milliseconds SAVE_MAX_DELAY{3000};
+
+	Format m_format;
+
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::optional<DeviceSettings> m_pending;
+	std::chrono::steady_clock::time_point m_pending_since, m_pending_deadline;
+	bool m_exiting = false;
+
+	std::mutex m_write_mutex; // Serializes the worker and flush()
+	std::thread m_worker;
+
+	void worker();
+	bool write(const DeviceSettings& settings, Format format);
+
+	static bool read_binary(DeviceSettings& settings);
+	static bool read_xml(DeviceSettings& settings, uint32_t const& legacy_port);
+};
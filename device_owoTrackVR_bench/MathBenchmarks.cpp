@@ -0,0 +1,277 @@
+#include <benchmark/benchmark.h>
+#include <basis.h>
+#include <quat.h>
+
+#include <random>
+#include <vector>
+
+// The owo math (Godot-derived) against the Eigen equivalents on the same
+// inputs, for one value at a time (/1) and for a batch of them (/1024)
+
+namespace
+{
+	constexpr int BATCH_SIZE = 1024;
+
+	Basis from_eigen(const Eigen::Matrix3d& matrix)
+	{
+		return {
+			matrix(0, 0), matrix(0, 1), matrix(0, 2),
+			matrix(1, 0), matrix(1, 1), matrix(1, 2),
+			matrix(2, 0), matrix(2, 1), matrix(2, 2)
+		};
+	}
+
+	// Basis::orthonormalize, in Eigen (axes are the columns)
+	Eigen::Matrix3d gram_schmidt(const Eigen::Matrix3d& m)
+	{
+		Eigen::Matrix3d r;
+		r.col(0) = m.col(0).normalized();
+		r.col(1) = (m.col(1) - r.col(0) * r.col(0).dot(m.col(1))).normalized();
+		r.col(2) = (m.col(2) - r.col(0) * r.col(0).dot(m.col(2)) -
+			r.col(1) * r.col(1).dot(m.col(2))).normalized();
+		return r;
+	}
+
+	// Both sides get the same rotations and vectors, from a fixed seed
+	struct Inputs
+	{
+		std::vector<Quat> quats_a, quats_b;
+		std::vector<Basis> bases, drifted_bases;
+		std::vector<Vector3> vectors;
+
+		std::vector<Eigen::Quaterniond> eigen_quats_a, eigen_quats_b;
+		std::vector<Eigen::Matrix3d> eigen_bases, eigen_drifted_bases;
+		std::vector<Eigen::Vector3d> eigen_vectors;
+		Eigen::Matrix3Xd eigen_vector_block;
+
+		std::vector<double> fractions;
+
+		Inputs()
+		{
+			std::mt19937 rng(6969);
+			std::srand(6969); // Eigen's UnitRandom uses rand()
+			std::uniform_real_distribution<double> coordinate(-2.0, 2.0), fraction(0.0, 1.0);
+			std::normal_distribution<double> noise(0.0, 0.01);
+
+			eigen_vector_block.resize(3, BATCH_SIZE);
+			for (int i = 0; i < BATCH_SIZE; i++)
+			{
+				eigen_quats_a.push_back(Eigen::Quaterniond::UnitRandom());
+				eigen_quats_b.push_back(Eigen::Quaterniond::UnitRandom());
+				eigen_bases.push_back(eigen_quats_a.back().toRotationMatrix());
+				eigen_vectors.emplace_back(coordinate(rng), coordinate(rng), coordinate(rng));
+				eigen_vector_block.col(i) = eigen_vectors.back();
+				fractions.push_back(fraction(rng));
+
+				Eigen::Matrix3d drifted = eigen_bases.back();
+				for (int j = 0; j < 9; j++)
+					drifted(j) += noise(rng);
+				eigen_drifted_bases.push_back(drifted);
+
+				quats_a.emplace_back(eigen_quats_a.back());
+				quats_b.emplace_back(eigen_quats_b.back());
+				bases.push_back(from_eigen(eigen_bases.back()));
+				drifted_bases.push_back(from_eigen(drifted));
+				vectors.emplace_back(eigen_vectors.back().x(), eigen_vectors.back().y(), eigen_vectors.back().z());
+			}
+		}
+	};
+
+	const Inputs& inputs()
+	{
+		static const Inputs instance;
+		return instance;
+	}
+
+	// Runs op over the first range(0) inputs per iteration
+	template <typename Result, typename Op>
+	void run_batch(benchmark::State& state, Op op)
+	{
+		const auto count = static_cast<int>(state.range(0));
+		std::vector<Result> results(count);
+
+		for (auto _ : state)
+		{
+			for (int i = 0; i < count; i++)
+				results[i] = op(i);
+
+			benchmark::DoNotOptimize(results.data());
+			benchmark::ClobberMemory();
+		}
+
+		state.SetItemsProcessed(state.iterations() * count);
+	}
+
+	void batch_sizes(benchmark::internal::Benchmark* benchmark)
+	{
+		benchmark->Arg(1)->Arg(BATCH_SIZE);
+	}
+}
+
+static void BM_QuatMultiply_owo(benchmark::State& state)
+{
+	const auto& in = inputs();
+	run_batch<Quat>(state, [&](const int i) { return in.quats_a[i] * in.quats_b[i]; });
+}
+
+static void BM_QuatMultiply_Eigen(benchmark::State& state)
+{
+	const auto& in = inputs();
+	run_batch<Eigen::Quaterniond>(state, [&](const int i) { return in.eigen_quats_a[i] * in.eigen_quats_b[i]; });
+}
+
+static void BM_BasisFromQuat_owo(benchmark::State& state)
+{
+	const auto& in = inputs();
+	run_batch<Basis>(state, [&](const int i) { return Basis(in.quats_a[i]); });
+}
+
+static void BM_BasisFromQuat_Eigen(benchmark::State& state)
+{
+	const auto& in = inputs();
+	run_batch<Eigen::Matrix3d>(state, [&](const int i) { return in.eigen_quats_a[i].toRotationMatrix(); });
+}
+
+static void BM_Xform_owo(benchmark::State& state)
+{
+	const auto& in = inputs();
+	run_batch<Vector3>(state, [&](const int i) { return in.bases[i].xform(in.vectors[i]); });
+}
+
+static void BM_Xform_Eigen(benchmark::State& state)
+{
+	const auto& in = inputs();
+	run_batch<Eigen::Vector3d>(state, [&](const int i) { return Eigen::Vector3d(in.eigen_bases[i] * in.eigen_vectors[i]); });
+}
+
+// One basis applied to many vectors, e.g. every offset of a frame
+static void BM_XformOneBasis_owo(benchmark::State& state)
+{
+	const auto& in = inputs();
+	run_batch<Vector3>(state, [&](const int i) { return in.bases[0].xform(in.vectors[i]); });
+}
+
+static void BM_XformOneBasis_Eigen(benchmark::State& state)
+{
+	// The whole batch as a single 3xN product
+	const auto& in = inputs();
+	const auto count = state.range(0);
+	Eigen::Matrix3Xd results(3, count);
+
+	for (auto _ : state)
+	{
+		results.noalias() = in.eigen_bases[0] * in.eigen_vector_block.leftCols(count);
+		benchmark::DoNotOptimize(results.data());
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed(state.iterations() * count);
+}
+
+static void BM_EulerYXZ_owo(benchmark::State& state)
+{
+	const auto& in = inputs();
+	run_batch<Vector3>(state, [&](const int i) { return in.quats_a[i].get_euler_yxz(); });
+}
+
+static void BM_EulerYXZ_Eigen(benchmark::State& state)
+{
+	const auto& in = inputs();
+	run_batch<Eigen::Vector3d>(state, [&](const int i)
+	{
+		return Eigen::Vector3d(in.eigen_quats_a[i].toRotationMatrix().eulerAngles(1, 0, 2));
+	});
+}
+
+static void BM_Slerp_owo(benchmark::State& state)
+{
+	const auto& in = inputs();
+	run_batch<Quat>(state, [&](const int i) { return in.quats_a[i].slerp(in.quats_b[i], in.fractions[i]); });
+}
+
+static void BM_Slerp_Eigen(benchmark::State& state)
+{
+	const auto& in = inputs();
+	run_batch<Eigen::Quaterniond>(state, [&](const int i)
+	{
+		return in.eigen_quats_a[i].slerp(in.fractions[i], in.eigen_quats_b[i]);
+	});
+}
+
+static void BM_Orthonormalize_owo(benchmark::State& state)
+{
+	const auto& in = inputs();
+	run_batch<Basis>(state, [&](const int i) { return in.drifted_bases[i].orthonormalized(); });
+}
+
+static void BM_Orthonormalize_Eigen(benchmark::State& state)
+{
+	const auto& in = inputs();
+	run_batch<Eigen::Matrix3d>(state, [&](const int i) { return gram_schmidt(in.eigen_drifted_bases[i]); });
+}
+
+// The offset part of DeviceHandler::calculatePose, with every offset
+// transformed once per axis and the tracker basis rebuilt for the predictor
+static void BM_PoseOffsets_PerAxis(benchmark::State& state)
+{
+	const auto& in = inputs();
+	run_batch<Eigen::Vector3d>(state, [&](const int i)
+	{
+		const Basis& offset_basis = in.bases[i];
+		const auto final_tracker_basis = Basis(in.quats_b[i]);
+
+		Eigen::Vector3d position(0, 0, 0);
+		for (int axis = 0; axis < 3; axis++)
+		{
+			position(axis) += in.vectors[i].get_axis(axis);
+			position(axis) += offset_basis.xform(in.vectors[i]).get_axis(axis);
+			position(axis) += final_tracker_basis.xform(in.vectors[i]).get_axis(axis);
+		}
+
+		const auto predictor_basis = Basis(in.quats_b[i]);
+		const Vector3 predicted = predictor_basis.xform(in.vectors[i]);
+		return Eigen::Vector3d(position + Eigen::Vector3d(predicted.x, predicted.y, predicted.z));
+	});
+}
+
+// The same, transforming each offset once and sharing the tracker basis
+static void BM_PoseOffsets_Once(benchmark::State& state)
+{
+	const auto& in = inputs();
+	run_batch<Eigen::Vector3d>(state, [&](const int i)
+	{
+		const Basis& offset_basis = in.bases[i];
+		const auto final_tracker_basis = Basis(in.quats_b[i]);
+
+		const Vector3 device_offset = offset_basis.xform(in.vectors[i]),
+		              tracker_offset = final_tracker_basis.xform(in.vectors[i]);
+
+		Eigen::Vector3d position(0, 0, 0);
+		for (int axis = 0; axis < 3; axis++)
+		{
+			position(axis) += in.vectors[i].get_axis(axis);
+			position(axis) += device_offset.get_axis(axis);
+			position(axis) += tracker_offset.get_axis(axis);
+		}
+
+		const Vector3 predicted = final_tracker_basis.xform(in.vectors[i]);
+		return Eigen::Vector3d(position + Eigen::Vector3d(predicted.x, predicted.y, predicted.z));
+	});
+}
+
+BENCHMARK(BM_QuatMultiply_owo)->Apply(batch_sizes);
+BENCHMARK(BM_QuatMultiply_Eigen)->Apply(batch_sizes);
+BENCHMARK(BM_BasisFromQuat_owo)->Apply(batch_sizes);
+BENCHMARK(BM_BasisFromQuat_Eigen)->Apply(batch_sizes);
+BENCHMARK(BM_Xform_owo)->Apply(batch_sizes);
+BENCHMARK(BM_Xform_Eigen)->Apply(batch_sizes);
+BENCHMARK(BM_XformOneBasis_owo)->Apply(batch_sizes);
+BENCHMARK(BM_XformOneBasis_Eigen)->Apply(batch_sizes);
+BENCHMARK(BM_EulerYXZ_owo)->Apply(batch_sizes);
+BENCHMARK(BM_EulerYXZ_Eigen)->Apply(batch_sizes);
+BENCHMARK(BM_Slerp_owo)->Apply(batch_sizes);
+BENCHMARK(BM_Slerp_Eigen)->Apply(batch_sizes);
+BENCHMARK(BM_Orthonormalize_owo)->Apply(batch_sizes);
+BENCHMARK(BM_Orthonormalize_Eigen)->Apply(batch_sizes);
+BENCHMARK(BM_PoseOffsets_PerAxis)->Apply(batch_sizes);
+BENCHMARK(BM_PoseOffsets_Once)->Apply(batch_sizes);
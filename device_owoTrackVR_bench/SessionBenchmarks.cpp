@@ -0,0 +1,180 @@
+#include <benchmark/benchmark.h>
+#include <DeviceSession.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <set>
+#include <vector>
+
+// Per-packet cost of the device state, pooled sessions against the
+// layout they replaced, with packets from many devices interleaved.
+// static_cache_lines_per_packet is how many distinct lines one packet
+// writes, counted from the field addresses (not measured misses),
+// i.e. the most it can miss once there are too many devices for the cache
+
+namespace
+{
+	constexpr int PACKETS = 4096;
+
+	using time_point = std::chrono::steady_clock::time_point;
+
+	// The layout before sessions: every buffer its own malloc,
+	// next to whatever the heap handed out in between
+	struct LegacyDevice
+	{
+		double* quat_buffer;
+		double* gyro_buffer;
+		double* accel_buffer;
+		char* buff_hello;
+
+		unsigned long long current_packet_id = 0;
+		bool new_data_available = false;
+		bool connection_dead = false;
+		unsigned long long last_contact_time = 0;
+		unsigned long long curr_time = 0;
+		time_point quat_timestamp;
+	};
+
+	// What the receive path does with one rotation packet
+	// (the receive buffer costs the same either way and is left out)
+	template <typename State>
+	void receive_rotation(State& state, double* quat, const float* packet,
+	                      const unsigned long long id, time_point const& now)
+	{
+		if (id <= state.current_packet_id) return;
+		state.current_packet_id = id;
+
+		for (int i = 0; i < 4; i++)
+			quat[i] = packet[i];
+
+		state.new_data_available = true;
+		state.curr_time = id;
+		state.last_contact_time = id;
+		state.quat_timestamp = now;
+	}
+
+	int lines_touched(std::initializer_list<std::pair<const void*, size_t>> fields)
+	{
+		std::set<uintptr_t> lines;
+		for (const auto& [address, size] : fields)
+		{
+			const auto first = reinterpret_cast<uintptr_t>(address);
+			for (auto line = first / SESSION_CACHE_LINE; line <= (first + size - 1) / SESSION_CACHE_LINE; line++)
+				lines.insert(line);
+		}
+		return static_cast<int>(lines.size());
+	}
+
+	template <typename State>
+	int lines_touched(const State& state, const double* quat)
+	{
+		return lines_touched({
+			{quat, sizeof(double) * 4},
+			{&state.current_packet_id, sizeof(state.current_packet_id)},
+			{&state.new_data_available, sizeof(state.new_data_available)},
+			{&state.curr_time, sizeof(state.curr_time)},
+			{&state.last_contact_time, sizeof(state.last_contact_time)},
+			{&state.quat_timestamp, sizeof(state.quat_timestamp)}
+		});
+	}
+
+	// Which device each packet comes from, same for both layouts
+	std::vector<int> packet_order(const int devices)
+	{
+		std::mt19937 rng(6969);
+		std::uniform_int_distribution<int> device(0, devices - 1);
+
+		std::vector<int> order(PACKETS);
+		for (auto& index : order) index = device(rng);
+		return order;
+	}
+
+	const float packet[4] = {0.0f, 0.0f, 0.6f, 0.8f};
+}
+
+static void BM_ReceiveRotation_Pooled(benchmark::State& state)
+{
+	// Sessions sit in one array, as in DeviceSessionPool
+	const auto devices = static_cast<int>(state.range(0));
+	std::vector<DeviceSession> sessions(devices);
+	const auto order = packet_order(devices);
+	const auto now = std::chrono::steady_clock::now();
+
+	unsigned long long id = 0; // Every packet is newer than the last
+	for (auto _ : state)
+	{
+		for (const int index : order)
+			receive_rotation(sessions[index].hot, sessions[index].hot.quat, packet, ++id, now);
+		benchmark::ClobberMemory();
+	}
+
+	double lines = 0;
+	for (const auto& session : sessions)
+		lines += lines_touched(session.hot, session.hot.quat);
+
+	state.counters["static_cache_lines_per_packet"] = lines / devices;
+	state.SetItemsProcessed(state.iterations() * PACKETS);
+}
+
+static void BM_ReceiveRotation_Scattered(benchmark::State& state)
+{
+	const auto devices = static_cast<int>(state.range(0));
+	const auto order = packet_order(devices);
+	const auto now = std::chrono::steady_clock::now();
+
+	// Allocated the way the servers used to be, with unrelated
+	// allocations of random sizes in between
+	std::mt19937 rng(6969);
+	std::uniform_int_distribution<size_t> filler_size(16, 512);
+	std::vector<void*> fillers;
+	std::vector<LegacyDevice*> legacy(devices);
+
+	const auto filler = [&]
+	{
+		fillers.push_back(std::malloc(filler_size(rng)));
+	};
+
+	for (auto& device : legacy)
+	{
+		device = new LegacyDevice();
+		filler();
+		device->quat_buffer = static_cast<double*>(std::malloc(sizeof(double) * 4));
+		filler();
+		device->gyro_buffer = static_cast<double*>(std::malloc(sizeof(double) * 3));
+		device->accel_buffer = static_cast<double*>(std::malloc(sizeof(double) * 3));
+		device->buff_hello = static_cast<char*>(std::malloc(16));
+		filler();
+		std::memset(device->quat_buffer, 0, sizeof(double) * 4);
+	}
+
+	unsigned long long id = 0; // Every packet is newer than the last
+	for (auto _ : state)
+	{
+		for (const int index : order)
+			receive_rotation(*legacy[index], legacy[index]->quat_buffer, packet, ++id, now);
+		benchmark::ClobberMemory();
+	}
+
+	double lines = 0;
+	for (const auto* device : legacy)
+		lines += lines_touched(*device, device->quat_buffer);
+
+	state.counters["static_cache_lines_per_packet"] = lines / devices;
+	state.SetItemsProcessed(state.iterations() * PACKETS);
+
+	for (auto* device : legacy)
+	{
+		std::free(device->quat_buffer);
+		std::free(device->gyro_buffer);
+		std::free(device->accel_buffer);
+		std::free(device->buff_hello);
+		delete device;
+	}
+	for (void* memory : fillers)
+		std::free(memory);
+}
+
+// A full pool, then far more devices than fit in L1 / L2
+BENCHMARK(BM_ReceiveRotation_Pooled)->Arg(DeviceSessionPool::MAX_SESSIONS)->Arg(1024)->Arg(65536);
+BENCHMARK(BM_ReceiveRotation_Scattered)->Arg(DeviceSessionPool::MAX_SESSIONS)->Arg(1024)->Arg(65536);
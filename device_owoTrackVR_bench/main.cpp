@@ -0,0 +1,5 @@
+#include <benchmark/benchmark.h>
+
+// For numbers to keep, run a Release build with
+// --benchmark_out=benchmarks.json --benchmark_out_format=json
+BENCHMARK_MAIN();
@@ -0,0 +1,7 @@
+// pch.h: The owo sources include this first, in the plugin it's the precompiled header.
+// Benchmarks build those sources without one, so this only has to exist.
+
+#ifndef PCH_H
+#define PCH_H
+
+#endif //PCH_H
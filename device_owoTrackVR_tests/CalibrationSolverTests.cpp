@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include <CalibrationSolver.h>
+
+#include <random>
+
+namespace
+{
+	constexpr int WINDOW_SIZE = 24;
+	constexpr int MIN_SAMPLES = 12;
+	constexpr double DEGREE = Math_PI / 180.0;
+
+	double angle_between(const Quat& a, const Quat& b)
+	{
+		return 2.0 * std::acos(std::min(1.0, std::abs(a.dot(b))));
+	}
+
+	// Fixed seed, failures have to be reproducible
+	class CalibrationSolverTest : public testing::Test {
+	protected:
+		CalibrationSolver solver;
+		CalibrationSolver::Result result;
+		std::mt19937 rng{6969};
+
+		const Quat target = Quat(Vector3(0, 40 * DEGREE, 0));
+
+		void SetUp() override
+		{
+			solver.begin();
+		}
+
+		// The target, shaken by up to the given angle around a random axis
+		Quat jittered(const double max_angle)
+		{
+			std::normal_distribution<double> axis(0.0, 1.0);
+			std::uniform_real_distribution<double> angle(-max_angle, max_angle);
+			return Quat(Vector3(axis(rng), axis(rng), axis(rng)).normalized(), angle(rng)) * target;
+		}
+
+		// Somewhere else entirely, the user turned around or the phone slipped
+		Quat outlier()
+		{
+			std::uniform_real_distribution<double> yaw(60 * DEGREE, 300 * DEGREE);
+			return Quat(Vector3(0, yaw(rng), 0)) * target;
+		}
+	};
+}
+
+TEST_F(CalibrationSolverTest, NothingToSolveWithoutSamples)
+{
+	EXPECT_FALSE(solver.try_solve(result));
+	EXPECT_FALSE(solver.solve_final(result));
+}
+
+TEST_F(CalibrationSolverTest, ConvergesWithinMinimumSamplesWhenStill)
+{
+	for (int i = 0; i < MIN_SAMPLES - 1; i++)
+		solver.push_sample(jittered(0.2 * DEGREE));
+	EXPECT_FALSE(solver.try_solve(result)); // Too early to tell
+
+	solver.push_sample(jittered(0.2 * DEGREE));
+	ASSERT_TRUE(solver.try_solve(result));
+
+	EXPECT_EQ(result.samples, MIN_SAMPLES);
+	EXPECT_LT(angle_between(result.rotation, target), 0.2 * DEGREE);
+}
+
+TEST_F(CalibrationSolverTest, DoesNotConvergeWithOverTwentyPercentOutliers)
+{
+	// 5 of 24 is just over 20%
+	for (int i = 0; i < WINDOW_SIZE; i++)
+		solver.push_sample(i % 5 == 0 ? outlier() : jittered(0.2 * DEGREE));
+	EXPECT_FALSE(solver.try_solve(result));
+
+	// The final solve still finds the still samples
+	ASSERT_TRUE(solver.solve_final(result));
+	EXPECT_EQ(result.samples, WINDOW_SIZE - 5);
+	EXPECT_LT(angle_between(result.rotation, target), 0.2 * DEGREE);
+}
+
+TEST_F(CalibrationSolverTest, ConvergesWithFewOutliers)
+{
+	// 4 of 24 is below 20%
+	for (int i = 0; i < WINDOW_SIZE; i++)
+		solver.push_sample(i % 6 == 0 ? outlier() : jittered(0.2 * DEGREE));
+	ASSERT_TRUE(solver.try_solve(result));
+
+	EXPECT_EQ(result.samples, WINDOW_SIZE - 4);
+	EXPECT_LT(angle_between(result.rotation, target), 0.2 * DEGREE);
+}
+
+TEST_F(CalibrationSolverTest, AveragesAcrossTheSignFlip)
+{
+	// q and -q are the same rotation, a component-wise mean would cancel out
+	for (int i = 0; i < WINDOW_SIZE; i++)
+	{
+		const Quat sample = jittered(0.5 * DEGREE);
+		solver.push_sample(i % 2 ? sample : -sample);
+	}
+	ASSERT_TRUE(solver.try_solve(result));
+
+	EXPECT_EQ(result.samples, WINDOW_SIZE);
+	EXPECT_NEAR(result.rotation.length(), 1.0, 1e-9);
+	EXPECT_LT(angle_between(result.rotation, target), 0.5 * DEGREE);
+}
+
+TEST_F(CalibrationSolverTest, ConfidenceFollowsTheSpread)
+{
+	for (int i = 0; i < WINDOW_SIZE; i++)
+		solver.push_sample(target);
+	ASSERT_TRUE(solver.try_solve(result));
+	EXPECT_NEAR(result.confidence, 1.0, 1e-6);
+
+	// Shaky, but not thrown away
+	solver.begin();
+	for (int i = 0; i < WINDOW_SIZE; i++)
+		solver.push_sample(jittered(4 * DEGREE));
+	ASSERT_TRUE(solver.solve_final(result));
+	EXPECT_GT(result.confidence, 0.3);
+	EXPECT_LT(result.confidence, 0.9);
+
+	// Rejected samples count against it too
+	solver.begin();
+	for (int i = 0; i < WINDOW_SIZE; i++)
+		solver.push_sample(i % 2 ? outlier() : target);
+	ASSERT_TRUE(solver.solve_final(result));
+	EXPECT_GE(result.confidence, 0.0);
+	EXPECT_LE(result.confidence, static_cast<double>(result.samples) / WINDOW_SIZE);
+}
@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include <NetworkedDeviceQuatServer.h>
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace
+{
+	// Just enough of a server to own a session and feed it packets
+	class FakeNetworkedServer : public NetworkedDeviceQuatServer {
+	public:
+		using NetworkedDeviceQuatServer::handle_rotation_packet;
+
+		void startListening(bool& _ret) override { _ret = true; }
+		void tick() override {}
+		bool isConnectionAlive() override { return true; }
+		void buzz(float duration_s, float frequency, float amplitude) override {}
+		int get_port() override { return 6969; }
+	};
+
+	template <typename T>
+	unsigned char* put_big_endian(unsigned char* into, const T value)
+	{
+		unsigned char bytes[sizeof(T)];
+		std::memcpy(bytes, &value, sizeof(T));
+		for (size_t i = 0; i < sizeof(T); i++)
+			into[i] = bytes[sizeof(T) - i - 1];
+		return into + sizeof(T);
+	}
+}
+
+TEST(DeviceSession, HotStateIsCacheLinePacked)
+{
+	EXPECT_EQ(alignof(DeviceSessionState), SESSION_CACHE_LINE);
+	EXPECT_LE(sizeof(DeviceSessionState), SESSION_CACHE_LINE * 2);
+
+	// Handshake results don't share a line with the per-packet state
+	const DeviceSession session;
+	const auto hot = reinterpret_cast<uintptr_t>(&session.hot);
+	const auto cold = reinterpret_cast<uintptr_t>(&session.cold);
+	EXPECT_GE(cold - hot, sizeof(DeviceSessionState));
+	EXPECT_EQ(cold % SESSION_CACHE_LINE, 0u);
+}
+
+TEST(DeviceSession, PoolBalancesAcquireAndRelease)
+{
+	auto& pool = DeviceSessionPool::instance();
+	const int baseline = pool.live_sessions();
+
+	std::vector<DeviceSession*> taken;
+	while (DeviceSession* session = pool.acquire())
+		taken.push_back(session);
+
+	EXPECT_EQ(static_cast<int>(taken.size()), DeviceSessionPool::MAX_SESSIONS - baseline);
+	EXPECT_EQ(pool.live_sessions(), DeviceSessionPool::MAX_SESSIONS);
+
+	for (DeviceSession* session : taken)
+		pool.release(session);
+
+	EXPECT_EQ(pool.live_sessions(), baseline);
+}
+
+TEST(DeviceSession, PoolResetsReusedSessions)
+{
+	auto& pool = DeviceSessionPool::instance();
+
+	DeviceSession* session = pool.acquire();
+	ASSERT_NE(session, nullptr);
+	session->hot.current_packet_id = 1234;
+	session->cold.device_features = FEATURE_SENSOR_RATE;
+	pool.release(session);
+
+	session = pool.acquire();
+	ASSERT_NE(session, nullptr);
+	EXPECT_EQ(session->hot.current_packet_id, 0u);
+	EXPECT_EQ(session->cold.device_features, 0u);
+	EXPECT_EQ(session->hot.quat[3], 1.0);
+	pool.release(session);
+}
+
+TEST(DeviceSession, PoolRejectsForeignAndDoubleRelease)
+{
+	auto& pool = DeviceSessionPool::instance();
+	const int baseline = pool.live_sessions();
+
+	DeviceSession* session = pool.acquire();
+	ASSERT_NE(session, nullptr);
+	pool.release(session);
+	pool.release(session); // Twice
+	EXPECT_EQ(pool.live_sessions(), baseline);
+
+	DeviceSession foreign;
+	pool.release(&foreign);
+	pool.release(nullptr);
+	EXPECT_EQ(pool.live_sessions(), baseline);
+
+	// Inside the pool, but not the start of a session
+	session = pool.acquire();
+	ASSERT_NE(session, nullptr);
+	pool.release(reinterpret_cast<DeviceSession*>(reinterpret_cast<char*>(session) + SESSION_CACHE_LINE));
+	EXPECT_EQ(pool.live_sessions(), baseline + 1);
+	pool.release(session);
+	EXPECT_EQ(pool.live_sessions(), baseline);
+}
+
+TEST(DeviceSession, ServersDontLeakSessions)
+{
+	auto& pool = DeviceSessionPool::instance();
+	const int baseline = pool.live_sessions();
+
+	// Connect / disconnect churn, many more times than there are sessions
+	for (int i = 0; i < DeviceSessionPool::MAX_SESSIONS * 4; i++)
+	{
+		const auto server = std::make_unique<FakeNetworkedServer>();
+		EXPECT_EQ(pool.live_sessions(), baseline + 1);
+	}
+
+	EXPECT_EQ(pool.live_sessions(), baseline);
+}
+
+TEST(DeviceSession, ServerThrowsWhenThePoolIsFull)
+{
+	auto& pool = DeviceSessionPool::instance();
+	const int baseline = pool.live_sessions();
+
+	{
+		std::vector<std::unique_ptr<FakeNetworkedServer>> servers;
+		for (int i = baseline; i < DeviceSessionPool::MAX_SESSIONS; i++)
+			servers.push_back(std::make_unique<FakeNetworkedServer>());
+
+		EXPECT_THROW(FakeNetworkedServer(), std::system_error);
+	}
+
+	EXPECT_EQ(pool.live_sessions(), baseline);
+}
+
+TEST(DeviceSession, RotationPacketLandsInTheSession)
+{
+	FakeNetworkedServer server;
+
+	unsigned char packet[MAX_MSG_SIZE] = {0};
+	unsigned char* at = put_big_endian<message_header_type_t>(packet, MSG_ROTATION);
+	at = put_big_endian<message_id_t>(at, 10);
+	for (const sensor_data_t value : {0.0f, 0.0f, 0.6f, 0.8f})
+		at = put_big_endian(at, value);
+
+	const auto arrival = std::chrono::steady_clock::now() - std::chrono::milliseconds(15);
+	server.handle_rotation_packet(packet, arrival);
+
+	ASSERT_TRUE(server.isDataAvailable());
+	EXPECT_FALSE(server.isDataAvailable()); // Consumed
+	EXPECT_FLOAT_EQ(server.getRotationQuaternion()[2], 0.6f);
+	EXPECT_FLOAT_EQ(server.getRotationQuaternion()[3], 0.8f);
+	EXPECT_EQ(server.getRotationTimestamp(), arrival);
+
+	// Older packets are dropped, timestamp included
+	put_big_endian<message_id_t>(packet + sizeof(message_header_type_t), 9);
+	server.handle_rotation_packet(packet, std::chrono::steady_clock::now());
+	EXPECT_FALSE(server.isDataAvailable());
+	EXPECT_EQ(server.getRotationTimestamp(), arrival);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <DeviceQuatServer.h>
+#include <HapticsScheduler.h>
+
+#include <vector>
+
+// Serves whatever sensor values the test sets,
+// and records every buzz it's asked for instead of sending it
+class FakeDeviceQuatServer : public DeviceQuatServer {
+public:
+	double quat[4] = {0, 0, 0, 1};
+	double gyro[3] = {0};
+	double accel[3] = {0};
+
+	std::vector<HapticStep> buzzes;
+	bool alive = true;
+
+	void startListening(bool& _ret) override { _ret = true; }
+	void tick() override {}
+
+	bool isDataAvailable() override { return false; }
+	double* getRotationQuaternion() override { return quat; }
+	std::chrono::steady_clock::time_point getRotationTimestamp() override { return {}; }
+	double* getGyroscope() override { return gyro; }
+	double* getAccel() override { return accel; }
+
+	bool isConnectionAlive() override { return alive; }
+
+	void buzz(float duration_s, float frequency, float amplitude) override
+	{
+		buzzes.push_back({duration_s, frequency, amplitude});
+	}
+
+	int get_port() override { return 6969; }
+};
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include <HMDPoseHistory.h>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+	// Fake HMD: moves 1m/s along X and turns 90deg/s around Y
+	HMDPoseHistory::pose_t fake_hmd_pose(const double seconds)
+	{
+		return {
+			Eigen::Vector3d(seconds, 0, 0),
+			Eigen::Quaterniond(Eigen::AngleAxisd(seconds * EIGEN_PI / 2.0, Eigen::Vector3d::UnitY()))
+		};
+	}
+
+	// Pushes the fake pose every 10ms for the given number of frames
+	HMDPoseHistory::clock::time_point fill(HMDPoseHistory& history, const int frames)
+	{
+		const auto start = HMDPoseHistory::clock::now();
+		for (int i = 0; i < frames; i++)
+			history.push(start + i * 10ms, fake_hmd_pose(i * 0.01));
+		return start;
+	}
+}
+
+TEST(HMDPoseHistory, EmptyHasNoSample)
+{
+	HMDPoseHistory history;
+	HMDPoseHistory::pose_t pose;
+
+	EXPECT_FALSE(history.sample(HMDPoseHistory::clock::now(), pose));
+}
+
+TEST(HMDPoseHistory, InterpolatesBetweenFrames)
+{
+	HMDPoseHistory history;
+	const auto start = fill(history, 10);
+
+	HMDPoseHistory::pose_t pose;
+	ASSERT_TRUE(history.sample(start + 45ms, pose));
+
+	const auto expected = fake_hmd_pose(0.045);
+	EXPECT_NEAR(pose.first.x(), expected.first.x(), 1e-9);
+	EXPECT_NEAR(pose.second.angularDistance(expected.second), 0.0, 1e-9);
+}
+
+TEST(HMDPoseHistory, ExactFrameIsReturnedAsIs)
+{
+	HMDPoseHistory history;
+	const auto start = fill(history, 10);
+
+	HMDPoseHistory::pose_t pose;
+	ASSERT_TRUE(history.sample(start + 30ms, pose));
+	EXPECT_NEAR(pose.first.x(), 0.03, 1e-12);
+}
+
+TEST(HMDPoseHistory, ClampsToStoredRange)
+{
+	HMDPoseHistory history;
+	const auto start = fill(history, 10);
+
+	HMDPoseHistory::pose_t pose;
+	ASSERT_TRUE(history.sample(start + 1s, pose)); // Newer than the newest
+	EXPECT_NEAR(pose.first.x(), 0.09, 1e-12);
+
+	ASSERT_TRUE(history.sample(start - 1s, pose)); // Older than the oldest
+	EXPECT_NEAR(pose.first.x(), 0.0, 1e-12);
+}
+
+TEST(HMDPoseHistory, KeepsOnlyTheNewestFramesAfterWrapping)
+{
+	HMDPoseHistory history;
+	const auto start = fill(history, 100); // More than the history holds
+
+	HMDPoseHistory::pose_t pose;
+	ASSERT_TRUE(history.sample(start, pose)); // Long gone, clamps to the oldest kept
+	EXPECT_GT(pose.first.x(), 0.3);
+
+	ASSERT_TRUE(history.sample(start + 985ms, pose)); // Still interpolated
+	EXPECT_NEAR(pose.first.x(), 0.985, 1e-9);
+}
+
+TEST(HMDPoseHistory, ClearDropsEverything)
+{
+	HMDPoseHistory history;
+	fill(history, 10);
+	history.clear();
+
+	HMDPoseHistory::pose_t pose;
+	EXPECT_FALSE(history.sample(HMDPoseHistory::clock::now(), pose));
+}
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include <HapticsScheduler.h>
+#include "FakeDeviceQuatServer.h"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+	// A single buzz queued at the given time
+	void buzz_at(HapticsScheduler& haptics, DeviceQuatServer& device, const HapticStep& step,
+	             HapticsScheduler::clock::time_point const& now)
+	{
+		haptics.play(&device, &step, 1, now);
+	}
+
+	void expect_step(const HapticStep& step, const float duration_s, const float frequency, const float amplitude)
+	{
+		EXPECT_FLOAT_EQ(step.duration_s, duration_s);
+		EXPECT_FLOAT_EQ(step.frequency, frequency);
+		EXPECT_FLOAT_EQ(step.amplitude, amplitude);
+	}
+}
+
+TEST(HapticsScheduler, SendsQueuedBuzzOnTick)
+{
+	HapticsScheduler haptics;
+	FakeDeviceQuatServer device;
+
+	haptics.buzz(&device, 0.2f, 100.0f, 0.5f);
+	EXPECT_TRUE(device.buzzes.empty()); // Nothing until the network thread ticks
+
+	haptics.tick();
+	ASSERT_EQ(device.buzzes.size(), 1u);
+	expect_step(device.buzzes[0], 0.2f, 100.0f, 0.5f);
+}
+
+TEST(HapticsScheduler, MergesOverlappingRequests)
+{
+	HapticsScheduler haptics;
+	FakeDeviceQuatServer device;
+	const auto now = HapticsScheduler::clock::now();
+
+	const HapticStep pattern[] = {{0.1f, 80.0f, 0.3f}, {0.05f, 120.0f, 0.9f}};
+	haptics.play(&device, pattern, 2, now);
+	buzz_at(haptics, device, {0.3f, 100.0f, 0.5f}, now);
+
+	haptics.tick(now);
+	haptics.tick(now + 300ms);
+
+	// The stronger value of each pending step wins
+	ASSERT_EQ(device.buzzes.size(), 2u);
+	expect_step(device.buzzes[0], 0.3f, 100.0f, 0.5f);
+	expect_step(device.buzzes[1], 0.05f, 120.0f, 0.9f);
+}
+
+TEST(HapticsScheduler, DropsBuzzCoveredByThePlayingOne)
+{
+	HapticsScheduler haptics;
+	FakeDeviceQuatServer device;
+	const auto now = HapticsScheduler::clock::now();
+
+	buzz_at(haptics, device, {0.5f, 100.0f, 0.8f}, now);
+	haptics.tick(now);
+
+	// Ends earlier and is weaker, nothing to add
+	buzz_at(haptics, device, {0.1f, 100.0f, 0.5f}, now + 50ms);
+	haptics.tick(now + 600ms);
+	EXPECT_EQ(device.buzzes.size(), 1u);
+
+	// Stronger, so it still gets through
+	buzz_at(haptics, device, {0.1f, 100.0f, 1.0f}, now + 650ms);
+	haptics.tick(now + 650ms);
+	EXPECT_EQ(device.buzzes.size(), 2u);
+}
+
+TEST(HapticsScheduler, SpacesBuzzesAtLeastTheMinimumInterval)
+{
+	HapticsScheduler haptics;
+	FakeDeviceQuatServer device;
+	const auto now = HapticsScheduler::clock::now();
+
+	const HapticStep pattern[] = {{0.01f, 100.0f, 0.5f}, {0.01f, 100.0f, 0.6f}, {0.01f, 100.0f, 0.7f}};
+	haptics.play(&device, pattern, 3, now);
+
+	// Much shorter than the interval, the next step still has to wait
+	haptics.tick(now);
+	haptics.tick(now + 10ms);
+	haptics.tick(now + HapticsScheduler::MIN_BUZZ_INTERVAL - 1ms);
+	EXPECT_EQ(device.buzzes.size(), 1u);
+
+	haptics.tick(now + HapticsScheduler::MIN_BUZZ_INTERVAL);
+	EXPECT_EQ(device.buzzes.size(), 2u);
+
+	haptics.tick(now + HapticsScheduler::MIN_BUZZ_INTERVAL * 2);
+	ASSERT_EQ(device.buzzes.size(), 3u);
+	EXPECT_FLOAT_EQ(device.buzzes[2].amplitude, 0.7f);
+}
+
+TEST(HapticsScheduler, DropsPatternForDeadDevice)
+{
+	HapticsScheduler haptics;
+	FakeDeviceQuatServer device;
+	const auto now = HapticsScheduler::clock::now();
+
+	const HapticStep pattern[] = {{0.01f, 100.0f, 0.5f}, {0.01f, 100.0f, 0.6f}};
+	haptics.play(&device, pattern, 2, now);
+
+	device.alive = false;
+	haptics.tick(now);
+	device.alive = true;
+	haptics.tick(now + 1s);
+
+	EXPECT_TRUE(device.buzzes.empty());
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include <InfoServer.h>
+
+#include "Loopback.h"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+	// The phone's side of discovery, against a real InfoServer over loopback
+	class InfoServerTest : public testing::Test {
+	protected:
+		LoopbackClient phone; // Also holds the WSA session, so it goes first
+		bool bound = false;
+		InfoServer server{bound};
+
+		std::function<void()> tick = [this] { server.tick(); };
+
+		void SetUp() override
+		{
+			ASSERT_TRUE(bound) << "The discovery port is taken";
+		}
+
+		void discover(std::string const& request = "DISCOVERY")
+		{
+			phone.send(server.get_port(), request);
+		}
+	};
+}
+
+TEST_F(InfoServerTest, NoTrackersNoReply)
+{
+	std::string reply;
+	discover();
+	EXPECT_FALSE(phone.receive_quick(reply, tick));
+}
+
+TEST_F(InfoServerTest, ReplyListsEveryTracker)
+{
+	server.add_tracker(6969, "Hip");
+	server.add_tracker(6970, "Left foot");
+	server.add_tracker(6969, "Waist"); // Same port, renamed
+
+	std::string reply;
+	discover();
+	ASSERT_TRUE(phone.receive(reply, tick));
+	EXPECT_EQ(reply, "6969:Waist\n6970:Left foot\n");
+}
+
+TEST_F(InfoServerTest, ReplyChangesAfterRemovingTracker)
+{
+	server.add_tracker(6969, "Hip");
+	server.add_tracker(6970, "Left foot");
+
+	std::string reply;
+	discover();
+	ASSERT_TRUE(phone.receive(reply, tick));
+	EXPECT_EQ(reply, "6969:Hip\n6970:Left foot\n");
+
+	server.remove_tracker(6969);
+	std::this_thread::sleep_for(InfoServer::MIN_REPLY_INTERVAL);
+
+	discover();
+	ASSERT_TRUE(phone.receive(reply, tick));
+	EXPECT_EQ(reply, "6970:Left foot\n");
+}
+
+TEST_F(InfoServerTest, MatchesOnlyTheDiscoveryRequest)
+{
+	server.add_tracker(6969, "Hip");
+	std::string reply;
+
+	// Longer words, shorter ones and a full buffer with no terminator anywhere
+	discover("DISCOVERYxxx");
+	discover("DISCOVER");
+	discover("xDISCOVERY");
+	discover(std::string(200, 'D'));
+	EXPECT_FALSE(phone.receive_quick(reply, tick));
+
+	// Bare, as older apps send it
+	discover("DISCOVERY");
+	ASSERT_TRUE(phone.receive(reply, tick));
+	EXPECT_EQ(reply, "6969:Hip\n");
+
+	std::this_thread::sleep_for(InfoServer::MIN_REPLY_INTERVAL);
+
+	// Terminated, with whatever was left in the sender's buffer after it
+	discover(std::string("DISCOVERY\0junk", 14));
+	ASSERT_TRUE(phone.receive(reply, tick));
+	EXPECT_EQ(reply, "6969:Hip\n");
+}
+
+TEST_F(InfoServerTest, RateLimitsEachSource)
+{
+	server.add_tracker(6969, "Hip");
+	std::string reply;
+
+	discover();
+	ASSERT_TRUE(phone.receive(reply, tick));
+
+	discover(); // Too soon
+	EXPECT_FALSE(phone.receive_quick(reply, tick));
+
+	std::this_thread::sleep_for(InfoServer::MIN_REPLY_INTERVAL);
+	discover();
+	EXPECT_TRUE(phone.receive(reply, tick));
+}
+
+TEST_F(InfoServerTest, TickHandlesBoundedNumberOfRequests)
+{
+	server.add_tracker(6969, "Hip");
+	std::string reply;
+
+	// A tick's worth of junk queued in front of the real request
+	for (int i = 0; i < InfoServer::MAX_REQUESTS_PER_TICK; i++)
+		discover("junk");
+	discover();
+	std::this_thread::sleep_for(50ms); // Let it all arrive
+
+	server.tick();
+	EXPECT_FALSE(phone.receive_quick(reply, [] {}));
+
+	server.tick();
+	EXPECT_TRUE(phone.receive(reply, [] {}));
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <Network.h>
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+
+// A phone on 127.0.0.1, for talking to the servers under test
+class LoopbackClient {
+public:
+	void send(const uint32_t port, const void* data, const int len)
+	{
+		socket.SendTo("127.0.0.1", static_cast<unsigned short>(port), static_cast<const char*>(data), len);
+	}
+
+	void send(const uint32_t port, std::string const& data)
+	{
+		send(port, data.data(), static_cast<int>(data.size()));
+	}
+
+	// Ticks the server until a datagram comes back, false if none did in time
+	bool receive(std::string& datagram, std::function<void()> const& tick,
+	             const std::chrono::milliseconds timeout = std::chrono::milliseconds(1000))
+	{
+		const auto deadline = std::chrono::steady_clock::now() + timeout;
+		do
+		{
+			tick();
+
+			sockaddr_in from;
+			int received = 0;
+			if (socket.RecvFrom(buffer, static_cast<int>(sizeof(buffer)), reinterpret_cast<SOCKADDR*>(&from), received))
+			{
+				datagram.assign(buffer, received);
+				return true;
+			}
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		while (std::chrono::steady_clock::now() < deadline);
+
+		return false;
+	}
+
+	// For checking that nothing comes back, waits less than a reply could take to be wrong
+	bool receive_quick(std::string& datagram, std::function<void()> const& tick)
+	{
+		return receive(datagram, tick, std::chrono::milliseconds(100));
+	}
+
+private:
+	WSASession session;
+	UDPSocket socket;
+	char buffer[512];
+};
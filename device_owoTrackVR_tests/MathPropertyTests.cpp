@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+#include <basis.h>
+#include <quat.h>
+
+#include <random>
+#include <vector>
+
+// The owo math (Godot-derived) against the Eigen equivalents,
+// on the same random inputs, so either can be swapped in for the other
+
+namespace
+{
+	constexpr int SAMPLES = 1000;
+	constexpr double TOLERANCE = 1e-12;
+
+	Eigen::Matrix3d to_eigen(const Basis& basis)
+	{
+		Eigen::Matrix3d matrix;
+		for (int row = 0; row < 3; row++)
+			for (int col = 0; col < 3; col++)
+				matrix(row, col) = basis.elements[row][col];
+		return matrix;
+	}
+
+	Basis from_eigen(const Eigen::Matrix3d& matrix)
+	{
+		return {
+			matrix(0, 0), matrix(0, 1), matrix(0, 2),
+			matrix(1, 0), matrix(1, 1), matrix(1, 2),
+			matrix(2, 0), matrix(2, 1), matrix(2, 2)
+		};
+	}
+
+	Eigen::Vector3d to_eigen(const Vector3& vector)
+	{
+		return {vector.x, vector.y, vector.z};
+	}
+
+	// Fixed seed, failures have to be reproducible
+	class MathProperty : public testing::Test {
+	protected:
+		std::mt19937 rng{6969};
+
+		Eigen::Quaterniond random_rotation()
+		{
+			return Eigen::Quaterniond::UnitRandom();
+		}
+
+		Eigen::Vector3d random_vector()
+		{
+			std::uniform_real_distribution<double> coordinate(-2.0, 2.0);
+			return {coordinate(rng), coordinate(rng), coordinate(rng)};
+		}
+
+		double random_fraction()
+		{
+			return std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+		}
+
+		void SetUp() override
+		{
+			std::srand(6969); // Eigen's UnitRandom uses rand()
+		}
+	};
+
+	// Same rotation, q and -q included
+	void expect_same_rotation(const Eigen::Quaterniond& a, const Eigen::Quaterniond& b, const double tolerance)
+	{
+		EXPECT_NEAR(std::abs(a.dot(b)), 1.0, tolerance);
+	}
+
+	void expect_near(const Eigen::Matrix3d& a, const Eigen::Matrix3d& b, const double tolerance)
+	{
+		EXPECT_LT((a - b).cwiseAbs().maxCoeff(), tolerance) << a << "\n\n" << b;
+	}
+
+	void expect_near(const Eigen::Vector3d& a, const Eigen::Vector3d& b, const double tolerance)
+	{
+		EXPECT_LT((a - b).cwiseAbs().maxCoeff(), tolerance) << a.transpose() << " vs " << b.transpose();
+	}
+}
+
+TEST_F(MathProperty, QuatConversionRoundTrips)
+{
+	for (int i = 0; i < SAMPLES; i++)
+	{
+		const auto q = random_rotation();
+		EXPECT_TRUE(Quat(q).to_eigen<double>().coeffs() == q.coeffs());
+	}
+}
+
+TEST_F(MathProperty, QuatMultiplyMatchesEigen)
+{
+	for (int i = 0; i < SAMPLES; i++)
+	{
+		const auto a = random_rotation(), b = random_rotation();
+		const auto owo = (Quat(a) * Quat(b)).to_eigen<double>();
+
+		EXPECT_LT((owo.coeffs() - (a * b).coeffs()).cwiseAbs().maxCoeff(), TOLERANCE);
+	}
+}
+
+TEST_F(MathProperty, BasisFromQuatMatchesEigen)
+{
+	for (int i = 0; i < SAMPLES; i++)
+	{
+		const auto q = random_rotation();
+		expect_near(to_eigen(Basis(Quat(q))), q.toRotationMatrix(), TOLERANCE);
+	}
+}
+
+TEST_F(MathProperty, XformMatchesEigen)
+{
+	for (int i = 0; i < SAMPLES; i++)
+	{
+		const auto q = random_rotation();
+		const auto v = random_vector();
+		const Vector3 owo_v(v.x(), v.y(), v.z());
+
+		expect_near(to_eigen(Basis(Quat(q)).xform(owo_v)), q.toRotationMatrix() * v, TOLERANCE);
+		expect_near(to_eigen(Quat(q).xform(owo_v)), q * v, TOLERANCE);
+	}
+}
+
+TEST_F(MathProperty, EulerYXZRebuildsTheRotation)
+{
+	// The angles themselves may differ between conventions near
+	// gimbal lock, the rotation they describe may not
+	const auto rebuild = [](const double x, const double y, const double z)
+	{
+		return Eigen::Quaterniond(
+			Eigen::AngleAxisd(y, Eigen::Vector3d::UnitY()) *
+			Eigen::AngleAxisd(x, Eigen::Vector3d::UnitX()) *
+			Eigen::AngleAxisd(z, Eigen::Vector3d::UnitZ()));
+	};
+
+	for (int i = 0; i < SAMPLES; i++)
+	{
+		const auto q = random_rotation();
+
+		const Vector3 owo = Quat(q).get_euler_yxz();
+		expect_same_rotation(rebuild(owo.x, owo.y, owo.z), q, 1e-9);
+
+		const Eigen::Vector3d eigen = q.toRotationMatrix().eulerAngles(1, 0, 2); // y, x, z
+		expect_same_rotation(rebuild(eigen[1], eigen[0], eigen[2]), q, 1e-9);
+	}
+}
+
+TEST_F(MathProperty, EulerYXZYawMatchesEigenAwayFromGimbalLock)
+{
+	// Yaw is what calibration and drift correction read
+	for (int i = 0; i < SAMPLES; i++)
+	{
+		const Eigen::Quaterniond q(
+			Eigen::AngleAxisd((random_fraction() * 2.0 - 1.0) * Math_PI, Eigen::Vector3d::UnitY()) *
+			Eigen::AngleAxisd((random_fraction() - 0.5) * Math_PI * 0.9, Eigen::Vector3d::UnitX()));
+
+		const double owo_yaw = Quat(q).get_euler_yxz().y;
+		const Eigen::Vector3d forward = q * Eigen::Vector3d::UnitZ();
+		const double eigen_yaw = std::atan2(forward.x(), forward.z());
+
+		EXPECT_NEAR(std::remainder(owo_yaw - eigen_yaw, 2.0 * Math_PI), 0.0, 1e-9);
+	}
+}
+
+TEST_F(MathProperty, SlerpMatchesEigen)
+{
+	for (int i = 0; i < SAMPLES; i++)
+	{
+		const auto a = random_rotation(), b = random_rotation();
+		const double t = random_fraction();
+
+		expect_same_rotation(Quat(a).slerp(Quat(b), t).to_eigen<double>(), a.slerp(t, b), 1e-9);
+	}
+}
+
+TEST_F(MathProperty, OrthonormalizeMatchesEigenGramSchmidt)
+{
+	std::normal_distribution<double> noise(0.0, 0.01);
+
+	for (int i = 0; i < SAMPLES; i++)
+	{
+		Eigen::Matrix3d drifted = random_rotation().toRotationMatrix();
+		for (int j = 0; j < 9; j++)
+			drifted(j) += noise(rng);
+
+		// Basis axes are the matrix columns
+		Eigen::Matrix3d eigen;
+		eigen.col(0) = drifted.col(0).normalized();
+		eigen.col(1) = (drifted.col(1) - eigen.col(0) * eigen.col(0).dot(drifted.col(1))).normalized();
+		eigen.col(2) = (drifted.col(2) - eigen.col(0) * eigen.col(0).dot(drifted.col(2)) -
+			eigen.col(1) * eigen.col(1).dot(drifted.col(2))).normalized();
+
+		const Basis owo = from_eigen(drifted).orthonormalized();
+		expect_near(to_eigen(owo), eigen, TOLERANCE);
+		EXPECT_TRUE(owo.is_orthogonal());
+	}
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include <PositionPredictor.h>
+#include <StationaryDetector.h>
+#include "FakeDeviceQuatServer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+// Replays sensor data through the predictor the way the pose thread does,
+// with and without the stationary flag (zero-velocity updates), and
+// measures how far the predicted offset drifts while the device is at rest
+
+namespace
+{
+	constexpr int RATE = 100; // Poses per second
+
+	struct Phase
+	{
+		double seconds;
+		double accel_x; // m/s^2, gravity removed
+	};
+
+	struct Drift
+	{
+		double max = 0.0, final = 0.0; // Predicted offset while resting, m
+	};
+
+	Drift replay(const std::vector<Phase>& phases, const bool use_stationary)
+	{
+		FakeDeviceQuatServer device;
+		PositionPredictor predictor;
+		StationaryDetector detector;
+		const Basis basis; // Lying flat, facing forward
+
+		// Fixed seed, failures have to be reproducible
+		std::mt19937 rng(6969);
+		std::normal_distribution<double> gyro_noise(0.0, 0.003), accel_noise(0.0, 0.05);
+
+		Drift drift;
+		for (const auto& phase : phases)
+			for (int i = 0; i < static_cast<int>(phase.seconds * RATE); i++)
+			{
+				for (int axis = 0; axis < 3; axis++)
+				{
+					device.gyro[axis] = gyro_noise(rng);
+					device.accel[axis] = accel_noise(rng);
+				}
+				device.accel[0] += phase.accel_x;
+
+				detector.push(device.gyro, device.accel);
+				const bool stationary = use_stationary && detector.is_stationary();
+				const double offset = predictor.predict(device, basis, stationary).length();
+
+				if (detector.is_stationary())
+				{
+					drift.max = std::max(drift.max, offset);
+					drift.final = offset;
+				}
+			}
+
+		return drift;
+	}
+
+	void report(const char* name, const Drift& without, const Drift& with)
+	{
+		std::printf("[          ] %-14s drift at rest without the stationary flag: max %6.2f final %6.2f mm,"
+		            " with: max %6.2f final %6.2f mm\n", name,
+		            without.max * 1000, without.final * 1000, with.max * 1000, with.final * 1000);
+	}
+}
+
+TEST(PositionPredictor, StationaryFlagStopsBiasDrift)
+{
+	// An accelerometer bias past the dead zone, on a phone lying still for a minute
+	const std::vector<Phase> phases{{60.0, 0.3}};
+	const Drift without = replay(phases, false), with = replay(phases, true);
+	report("biased, still", without, with);
+
+	EXPECT_GT(without.final, 0.01); // Centimetres off, and it stays there
+	EXPECT_LT(with.max, 0.005); // Before the detector has a full window
+	EXPECT_LT(with.final, 0.0001);
+}
+
+TEST(PositionPredictor, StationaryFlagSettlesAfterMotion)
+{
+	// Picked up, moved, put down again, then left alone
+	const std::vector<Phase> phases{{2.0, 0.0}, {0.3, 3.0}, {0.3, -3.0}, {10.0, 0.3}};
+	const Drift without = replay(phases, false), with = replay(phases, true);
+	report("moved, put down", without, with);
+
+	EXPECT_LT(with.final, without.final);
+	EXPECT_LT(with.final, 0.0001);
+}
+
+TEST(PositionPredictor, SettlesOnceTheOffsetHasDecayed)
+{
+	FakeDeviceQuatServer device;
+	PositionPredictor predictor;
+	const Basis basis;
+	EXPECT_TRUE(predictor.is_settled());
+
+	device.accel[0] = 3.0;
+	for (int i = 0; i < 30; i++)
+		predictor.predict(device, basis, false);
+	EXPECT_FALSE(predictor.is_settled());
+
+	// At rest the offset keeps decaying, poses can't be reused until it's gone
+	device.accel[0] = 0.0;
+	int poses = 0;
+	while (!predictor.is_settled() && poses < 10 * RATE)
+	{
+		predictor.predict(device, basis, true);
+		poses++;
+	}
+	EXPECT_TRUE(predictor.is_settled());
+	EXPECT_GT(poses, 1);
+	EXPECT_LT(predictor.predict(device, basis, true).length(), 0.0001);
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <SensorRateController.h>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+	const double resting[3] = {0.0, 0.01, 0.0};
+	const double turning[3] = {0.0, 1.0, 0.0};
+
+	// Feeds the same gyro sample every 10ms (100Hz) for the given time
+	SensorRateController::clock::time_point feed(SensorRateController& controller, const double* gyro,
+	                                             SensorRateController::clock::time_point now,
+	                                             const std::chrono::milliseconds duration)
+	{
+		for (const auto end = now + duration; now < end; now += 10ms)
+			controller.push_gyro(gyro, now);
+		return now;
+	}
+}
+
+TEST(SensorRateController, StartsAtFullRate)
+{
+	SensorRateController controller;
+	uint32_t rate = 0;
+
+	ASSERT_TRUE(controller.poll(SensorRateController::clock::now(), rate));
+	EXPECT_EQ(rate, SensorRateController::RATE_ACTIVE_HZ);
+}
+
+TEST(SensorRateController, SlowsDownOnlyAfterResting)
+{
+	SensorRateController controller;
+	auto now = feed(controller, turning, SensorRateController::clock::now(), 500ms);
+
+	now = feed(controller, resting, now, 1000ms); // Shorter than the hold
+	EXPECT_EQ(controller.target_rate(), SensorRateController::RATE_ACTIVE_HZ);
+
+	feed(controller, resting, now, 3000ms);
+	EXPECT_EQ(controller.target_rate(), SensorRateController::RATE_IDLE_HZ);
+}
+
+TEST(SensorRateController, RestingFromTheStartStillWaitsForTheHold)
+{
+	// Right after a (re)connect, there's no motion to count the rest from
+	SensorRateController controller;
+	const auto now = feed(controller, resting, SensorRateController::clock::now(), 1000ms);
+	EXPECT_EQ(controller.target_rate(), SensorRateController::RATE_ACTIVE_HZ);
+
+	feed(controller, resting, now, 3000ms);
+	EXPECT_EQ(controller.target_rate(), SensorRateController::RATE_IDLE_HZ);
+}
+
+TEST(SensorRateController, SpeedsUpOnFirstMotion)
+{
+	SensorRateController controller;
+	auto now = feed(controller, turning, SensorRateController::clock::now(), 500ms);
+	now = feed(controller, resting, now, 5000ms);
+	ASSERT_EQ(controller.target_rate(), SensorRateController::RATE_IDLE_HZ);
+
+	controller.push_gyro(turning, now);
+	EXPECT_EQ(controller.target_rate(), SensorRateController::RATE_ACTIVE_HZ);
+}
+
+TEST(SensorRateController, SendsOnChangeAndResendsPeriodically)
+{
+	SensorRateController controller;
+	const auto start = SensorRateController::clock::now();
+	uint32_t rate = 0;
+
+	ASSERT_TRUE(controller.poll(start, rate));
+	EXPECT_FALSE(controller.poll(start + 1s, rate)); // Unchanged
+	EXPECT_TRUE(controller.poll(start + 6s, rate)); // Resend
+
+	auto now = feed(controller, turning, start + 6s, 500ms);
+	now = feed(controller, resting, now, 5000ms);
+	ASSERT_TRUE(controller.poll(now, rate)); // Changed
+	EXPECT_EQ(rate, SensorRateController::RATE_IDLE_HZ);
+}
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include <SettingsStore.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+#include <cereal/archives/xml.hpp>
+
+namespace
+{
+	// Points %APPDATA% at a scratch directory, so the store
+	// never touches (or picks up) the real Amethyst settings
+	class SettingsStoreTest : public testing::Test {
+	protected:
+		std::filesystem::path app_data =
+			std::filesystem::temp_directory_path() / L"device_owoTrackVR_tests";
+		std::filesystem::path settings_dir = app_data / L"Amethyst";
+		std::wstring old_app_data;
+
+		void SetUp() override
+		{
+			if (const wchar_t* value = _wgetenv(L"APPDATA")) old_app_data = value;
+
+			std::filesystem::remove_all(app_data);
+			std::filesystem::create_directories(settings_dir);
+			_wputenv_s(L"APPDATA", app_data.c_str());
+		}
+
+		void TearDown() override
+		{
+			_wputenv_s(L"APPDATA", old_app_data.c_str());
+			std::filesystem::remove_all(app_data);
+		}
+
+		[[nodiscard]] std::filesystem::path binary_file() const
+		{
+			return settings_dir / L"Device_OWO_settings.bin";
+		}
+
+		[[nodiscard]] std::filesystem::path xml_file() const
+		{
+			return settings_dir / L"Device_OWO_settings.xml";
+		}
+	};
+
+	void expect_tracker_eq(const TrackerSettings& actual, const TrackerSettings& expected)
+	{
+		EXPECT_TRUE(actual.m_device_offset.isApprox(expected.m_device_offset));
+		EXPECT_TRUE(actual.m_tracker_offset.isApprox(expected.m_tracker_offset));
+		EXPECT_TRUE(actual.m_global_rotation.isApprox(expected.m_global_rotation));
+		EXPECT_TRUE(actual.m_local_rotation.isApprox(expected.m_local_rotation));
+	}
+
+	TrackerSettings example_tracker()
+	{
+		TrackerSettings tracker;
+		tracker.m_device_offset = {0.01, -0.05, 0.1};
+		tracker.m_tracker_offset = {0, -0.8, 0};
+		tracker.m_global_rotation = Eigen::AngleAxisd(0.7, Eigen::Vector3d::UnitY());
+		tracker.m_local_rotation = Eigen::AngleAxisd(-0.2, Eigen::Vector3d::UnitX());
+		return tracker;
+	}
+}
+
+TEST_F(SettingsStoreTest, NothingToLoad)
+{
+	SettingsStore store;
+	DeviceSettings settings;
+
+	EXPECT_FALSE(store.load(settings, 6969));
+}
+
+TEST_F(SettingsStoreTest, MigratesTheLegacyXmlToPerTrackerBinary)
+{
+	const Eigen::Vector3d global_offset{0.1, 0.2, 0.3};
+	const TrackerSettings tracker = example_tracker();
+
+	// Written the way the single-tracker plugin used to
+	{
+		std::ofstream output(xml_file());
+		cereal::XMLOutputArchive archive(output);
+		archive(
+			cereal::make_nvp("m_global_offset", global_offset),
+			cereal::make_nvp("m_device_offset", tracker.m_device_offset),
+			cereal::make_nvp("m_tracker_offset", tracker.m_tracker_offset),
+			cereal::make_nvp("m_global_rotation", tracker.m_global_rotation),
+			cereal::make_nvp("m_local_rotation", tracker.m_local_rotation)
+		);
+	}
+
+	{
+		SettingsStore store;
+		DeviceSettings settings;
+		ASSERT_TRUE(store.load(settings, 6970));
+
+		EXPECT_TRUE(settings.m_global_offset.isApprox(global_offset));
+		ASSERT_EQ(settings.m_trackers.size(), 1u);
+		ASSERT_EQ(settings.m_trackers.count(6970), 1u);
+		expect_tracker_eq(settings.m_trackers.at(6970), tracker);
+	}
+
+	// The binary file is what gets read from now on
+	ASSERT_TRUE(std::filesystem::exists(binary_file()));
+	std::filesystem::remove(xml_file());
+
+	SettingsStore store;
+	DeviceSettings settings;
+	ASSERT_TRUE(store.load(settings, 6969)); // Not the legacy port anymore
+
+	EXPECT_TRUE(settings.m_global_offset.isApprox(global_offset));
+	ASSERT_EQ(settings.m_trackers.size(), 1u);
+	ASSERT_EQ(settings.m_trackers.count(6970), 1u);
+	expect_tracker_eq(settings.m_trackers.at(6970), tracker);
+}
+
+TEST_F(SettingsStoreTest, FlushWritesEveryTracker)
+{
+	DeviceSettings saved;
+	saved.m_global_offset = {0, 0.1, 0};
+	saved.m_trackers[6969] = example_tracker();
+	saved.m_trackers[6970] = {};
+
+	{
+		SettingsStore store;
+		store.save(saved);
+		store.flush();
+	}
+
+	SettingsStore store;
+	DeviceSettings settings;
+	ASSERT_TRUE(store.load(settings, 6969));
+
+	EXPECT_TRUE(settings.m_global_offset.isApprox(saved.m_global_offset));
+	ASSERT_EQ(settings.m_trackers.size(), 2u);
+	expect_tracker_eq(settings.m_trackers.at(6969), saved.m_trackers.at(6969));
+	expect_tracker_eq(settings.m_trackers.at(6970), saved.m_trackers.at(6970));
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include <StationaryDetector.h>
+
+namespace
+{
+	constexpr int WINDOW_SIZE = 16;
+
+	// Lying on the desk: sensor noise only, gravity already removed
+	const double still_gyro[3] = {0.004, -0.003, 0.002};
+	const double still_accel[3] = {0.02, -0.01, 0.03};
+
+	// Picked up and carried around
+	const double moving_gyro[3] = {0.6, -0.2, 0.9};
+	const double moving_accel[3] = {1.5, 0.4, -2.0};
+
+	void push(StationaryDetector& detector, const double* gyro, const double* accel, const int count)
+	{
+		for (int i = 0; i < count; i++)
+			detector.push(gyro, accel);
+	}
+}
+
+TEST(StationaryDetector, StillOnlyOnceTheWindowIsFull)
+{
+	StationaryDetector detector;
+
+	push(detector, still_gyro, still_accel, WINDOW_SIZE - 1);
+	EXPECT_FALSE(detector.is_stationary());
+
+	push(detector, still_gyro, still_accel, 1);
+	EXPECT_TRUE(detector.is_stationary());
+}
+
+TEST(StationaryDetector, MovingIsNeverStill)
+{
+	StationaryDetector detector;
+
+	push(detector, moving_gyro, moving_accel, WINDOW_SIZE * 4);
+	EXPECT_FALSE(detector.is_stationary());
+}
+
+TEST(StationaryDetector, SlowSteadyTurnIsNotStill)
+{
+	// Constant (so no variance), but clearly turning
+	const double turning[3] = {0.0, 0.1, 0.0};
+	StationaryDetector detector;
+
+	push(detector, turning, still_accel, WINDOW_SIZE * 4);
+	EXPECT_FALSE(detector.is_stationary());
+}
+
+TEST(StationaryDetector, MotionOnsetEndsStillnessImmediately)
+{
+	StationaryDetector detector;
+	push(detector, still_gyro, still_accel, WINDOW_SIZE * 4);
+	ASSERT_TRUE(detector.is_stationary());
+
+	push(detector, moving_gyro, moving_accel, 1);
+	EXPECT_FALSE(detector.is_stationary());
+}
+
+TEST(StationaryDetector, StillAgainOnceTheMotionLeavesTheWindow)
+{
+	StationaryDetector detector;
+	push(detector, still_gyro, still_accel, WINDOW_SIZE * 4);
+	push(detector, moving_gyro, moving_accel, 3);
+
+	push(detector, still_gyro, still_accel, WINDOW_SIZE - 1);
+	EXPECT_FALSE(detector.is_stationary()); // The last motion sample is still in
+
+	push(detector, still_gyro, still_accel, 1);
+	EXPECT_TRUE(detector.is_stationary());
+}
+
+TEST(StationaryDetector, ResetForgetsTheWindow)
+{
+	StationaryDetector detector;
+	push(detector, still_gyro, still_accel, WINDOW_SIZE);
+	ASSERT_TRUE(detector.is_stationary());
+
+	detector.reset();
+	EXPECT_FALSE(detector.is_stationary());
+}
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include <UDPDeviceQuatServer.h>
+#include "Loopback.h"
+
+#include <cstring>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+	// Client messages are big-endian
+	template <typename T>
+	unsigned char* put_big_endian(unsigned char* into, const T value)
+	{
+		unsigned char bytes[sizeof(T)];
+		std::memcpy(bytes, &value, sizeof(T));
+		for (size_t i = 0; i < sizeof(T); i++)
+			into[i] = bytes[sizeof(T) - i - 1];
+		return into + sizeof(T);
+	}
+
+	// A tracker on loopback, talking to a real server
+	class UDPDeviceQuatServerTest : public testing::Test {
+	protected:
+		uint32_t port = 16969; // Not the default, a real tracker may be running
+		LoopbackClient phone;
+		UDPDeviceQuatServer server{&port};
+		message_id_t next_id = 1;
+
+		void SetUp() override
+		{
+			bool bound = false;
+			server.startListening(bound);
+			ASSERT_TRUE(bound);
+		}
+
+		void handshake(const bool with_features)
+		{
+			unsigned char packet[MSG_HEADER_SIZE + sizeof(uint32_t) * 2];
+			unsigned char* at = put_big_endian<message_header_type_t>(packet, MSG_HANDSHAKE);
+			at = put_big_endian<message_id_t>(at, 0);
+
+			// Older devices stop after the header
+			if (with_features)
+			{
+				at = put_big_endian<uint32_t>(at, HANDSHAKE_FEATURES_MAGIC);
+				at = put_big_endian<uint32_t>(at, FEATURE_SENSOR_RATE);
+			}
+
+			phone.send(port, packet, static_cast<int>(at - packet));
+		}
+
+		void send_gyro(const float y)
+		{
+			unsigned char packet[MSG_HEADER_SIZE + sizeof(sensor_data_t) * 3];
+			unsigned char* at = put_big_endian<message_header_type_t>(packet, MSG_GYRO);
+			at = put_big_endian<message_id_t>(at, next_id++);
+			for (const sensor_data_t value : {0.0f, y, 0.0f})
+				at = put_big_endian(at, value);
+
+			phone.send(port, packet, static_cast<int>(at - packet));
+		}
+
+		// Ticks the server (with the phone lying still, if asked to) until
+		// a sensor rate message comes back, skipping everything else
+		bool receive_rate(uint32_t& rate_hz, const std::chrono::milliseconds timeout, const bool resting = false)
+		{
+			auto next_gyro = std::chrono::steady_clock::now();
+			const auto tick = [&]
+			{
+				if (resting && std::chrono::steady_clock::now() >= next_gyro)
+				{
+					send_gyro(0.01f);
+					next_gyro += 10ms; // 100Hz
+				}
+				server.tick();
+			};
+
+			const auto deadline = std::chrono::steady_clock::now() + timeout;
+			std::string datagram;
+			while (std::chrono::steady_clock::now() < deadline)
+			{
+				if (!phone.receive(datagram, tick, std::chrono::duration_cast<std::chrono::milliseconds>(
+					deadline - std::chrono::steady_clock::now())))
+					return false;
+
+				uint32_t type;
+				if (datagram.size() < sizeof(type)) continue;
+				std::memcpy(&type, datagram.data(), sizeof(type));
+				if (type != MSG_SERVER_SENSOR_RATE) continue;
+
+				// Server messages are in native byte order
+				EXPECT_EQ(datagram.size(), sizeof(uint32_t) * 2);
+				std::memcpy(&rate_hz, datagram.data() + sizeof(uint32_t), sizeof(rate_hz));
+				return true;
+			}
+			return false;
+		}
+	};
+}
+
+TEST_F(UDPDeviceQuatServerTest, RepliesToTheHandshake)
+{
+	handshake(false);
+
+	std::string reply;
+	ASSERT_TRUE(phone.receive(reply, [this] { server.tick(); }));
+	ASSERT_EQ(reply.size(), sizeof(HELLOMESSAGE));
+	EXPECT_EQ(reply[0], MSG_SERVER_HANDSHAKE);
+	EXPECT_EQ(reply.substr(1), std::string(HELLOMESSAGE + 1, sizeof(HELLOMESSAGE) - 1));
+}
+
+TEST_F(UDPDeviceQuatServerTest, SlowsDownDevicesThatAskForIt)
+{
+	handshake(true);
+
+	uint32_t rate_hz = 0;
+	ASSERT_TRUE(receive_rate(rate_hz, 1s));
+	EXPECT_EQ(rate_hz, SensorRateController::RATE_ACTIVE_HZ);
+
+	// Slows down only after resting for a while
+	const auto rest_start = std::chrono::steady_clock::now();
+	ASSERT_TRUE(receive_rate(rate_hz, 4s, true));
+	EXPECT_EQ(rate_hz, SensorRateController::RATE_IDLE_HZ);
+	EXPECT_GE(std::chrono::steady_clock::now() - rest_start, 1900ms);
+}
+
+TEST_F(UDPDeviceQuatServerTest, LeavesOlderDevicesAlone)
+{
+	handshake(false);
+
+	uint32_t rate_hz = 0;
+	EXPECT_FALSE(receive_rate(rate_hz, 3s, true));
+}
@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+#include <YawDriftEstimator.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+
+// Replays synthetic 30 minute sessions through the estimator
+// and compares the tracker's yaw error with and without correction
+
+namespace
+{
+	constexpr double DEGREE = Math_PI / 180.0;
+	constexpr double SESSION = 30 * 60; // s
+	constexpr double RATE = 60; // Rotation packets per second
+
+	double wrap_angle(const double angle)
+	{
+		return Math::fposmod(angle + Math_PI, Math_TAU) - Math_PI;
+	}
+
+	// Eases from 0 to 1 over [start, start + length]
+	double ramp(const double t, const double start, const double length = 0.5)
+	{
+		return std::clamp((t - start) / length, 0.0, 1.0);
+	}
+
+	// 1 during [start, end], with half a second of easing at either side
+	double hold(const double t, const double start, const double end)
+	{
+		return ramp(t, start) - ramp(t, end);
+	}
+
+	// 1 for `length` seconds of every `period`, starting at `offset`
+	double every(const double t, const double period, const double offset, const double length)
+	{
+		const double start = std::floor((t - offset) / period) * period + offset;
+		return t < offset ? 0.0 : hold(t, start, start + length);
+	}
+
+	struct Session
+	{
+		const char* name;
+		std::function<double(double)> drift; // Tracker yaw drift, rad
+		std::function<double(double)> look; // Head yaw relative to the body, rad
+		std::function<double(double)> twist; // Hip yaw relative to the body, rad
+	};
+
+	// The whole body turns now and then, and the head is never quite still
+	double body_yaw(const double t)
+	{
+		return 90 * DEGREE * every(t, 240, 100, 60) +
+			5 * DEGREE * std::sin(t * 0.05);
+	}
+
+	double head_sway(const double t)
+	{
+		return 3 * DEGREE * std::sin(t * 1.3) + 2 * DEGREE * std::sin(t * 0.31);
+	}
+
+	struct Result
+	{
+		double rms = 0.0, max = 0.0; // rad
+	};
+
+	Result replay(const Session& session, const bool correct)
+	{
+		YawDriftEstimator estimator;
+		const auto start = YawDriftEstimator::clock::time_point{};
+
+		double global_yaw = 0.0; // Calibrated with no drift, so 0 is right
+		double sum_squared = 0.0, max = 0.0;
+		double previous_tracker_yaw = 0.0;
+		int samples = 0;
+
+		for (double t = 0.0; t < SESSION; t += 1.0 / RATE)
+		{
+			const double body = body_yaw(t);
+			const double hmd_yaw = body + session.look(t) + head_sway(t);
+			const double hip_yaw = body + session.twist(t);
+			const double tracker_yaw = hip_yaw + session.drift(t); // As the phone reports it
+
+			const double gyro_rate = std::abs(wrap_angle(tracker_yaw - previous_tracker_yaw)) * RATE;
+			previous_tracker_yaw = tracker_yaw;
+
+			if (correct)
+				global_yaw += estimator.update(
+					start + std::chrono::microseconds(static_cast<long long>(t * 1e6)),
+					wrap_angle(tracker_yaw - hmd_yaw), global_yaw, hmd_yaw, gyro_rate);
+
+			// The global rotation should follow the drift exactly
+			const double error = wrap_angle(global_yaw - session.drift(t));
+			sum_squared += error * error;
+			max = std::max(max, std::abs(error));
+			samples++;
+		}
+
+		return {std::sqrt(sum_squared / samples), max};
+	}
+
+	void report(const Session& session, const Result& without, const Result& with)
+	{
+		std::printf("[          ] %-16s yaw error without correction: rms %5.2f max %5.2f deg,"
+		            " with: rms %5.2f max %5.2f deg\n", session.name,
+		            without.rms / DEGREE, without.max / DEGREE, with.rms / DEGREE, with.max / DEGREE);
+	}
+
+	double none(double) { return 0.0; }
+
+	double steady_drift(const double t)
+	{
+		return -0.5 * DEGREE * t / 60.0; // 15deg over the session
+	}
+
+	// Glances to the side, and minutes spent facing a second screen
+	double sideways_looks(const double t)
+	{
+		return 35 * DEGREE * every(t, 45, 10, 4) +
+			15 * DEGREE * every(t, 300, 30, 90) +
+			-10 * DEGREE * hold(t, 900, 1140);
+	}
+
+	// Leaning on one side of the chair, turning the hips to reach for something
+	double hip_twists(const double t)
+	{
+		return 12 * DEGREE * every(t, 360, 60, 120) +
+			-25 * DEGREE * every(t, 200, 150, 8);
+	}
+}
+
+TEST(YawDriftEstimator, CorrectsSteadyDrift)
+{
+	const Session session{"drift", steady_drift, none, none};
+	const Result without = replay(session, false), with = replay(session, true);
+	report(session, without, with);
+
+	EXPECT_LT(with.rms, 0.25 * without.rms);
+	EXPECT_LT(with.max, 0.5 * without.max);
+}
+
+TEST(YawDriftEstimator, IgnoresSidewaysLooks)
+{
+	const Session session{"sideways looks", none, sideways_looks, none};
+	const Result without = replay(session, false), with = replay(session, true);
+	report(session, without, with);
+
+	EXPECT_LT(with.rms, 2.5 * DEGREE);
+	EXPECT_LT(with.max, 5 * DEGREE);
+}
+
+TEST(YawDriftEstimator, IgnoresHipTwists)
+{
+	const Session session{"hip twists", none, none, hip_twists};
+	const Result without = replay(session, false), with = replay(session, true);
+	report(session, without, with);
+
+	EXPECT_LT(with.rms, 2.5 * DEGREE);
+	EXPECT_LT(with.max, 5 * DEGREE);
+}
+
+TEST(YawDriftEstimator, CorrectsDriftThroughLooksAndTwists)
+{
+	const Session session{"all of the above", steady_drift, sideways_looks, hip_twists};
+	const Result without = replay(session, false), with = replay(session, true);
+	report(session, without, with);
+
+	EXPECT_LT(with.rms, 0.25 * without.rms);
+	EXPECT_LT(with.max, 0.5 * without.max);
+}
+
+TEST(YawDriftEstimator, CorrectionIsBudgetedPerWindow)
+{
+	YawDriftEstimator estimator;
+	const auto start = YawDriftEstimator::clock::time_point{};
+
+	// Sitting perfectly still, 20deg off from the very first sample
+	double global_yaw = 0.0;
+	for (int i = 0; i < 120 * 60; i++)
+		global_yaw += estimator.update(start + std::chrono::microseconds(i * 1000000LL / 60),
+		                               20 * DEGREE, global_yaw, 0.0, 0.0);
+
+	// The full budget, plus what refilled during those two minutes
+	EXPECT_GT(global_yaw, 3 * DEGREE);
+	EXPECT_LE(global_yaw, 6 * DEGREE + 1e-9);
+}
+
+TEST(YawDriftEstimator, ResetForgetsTheDrift)
+{
+	YawDriftEstimator estimator;
+	const auto start = YawDriftEstimator::clock::time_point{};
+
+	for (int i = 0; i < 60 * 60; i++)
+		estimator.update(start + std::chrono::milliseconds(i * 1000 / 60), 0.1, 0.0, 0.0, 0.0);
+	EXPECT_NE(estimator.total_correction(), 0.0);
+
+	estimator.reset();
+	EXPECT_EQ(estimator.total_correction(), 0.0);
+	EXPECT_EQ(estimator.drift_rate(), 0.0);
+	EXPECT_EQ(estimator.confidence(), 0.0);
+}